@@ -0,0 +1,122 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#include "ns3/block-normal-random-variable.h"
+#include "ns3/log.h"
+#include "ns3/philox-rng.h"
+#include "ns3/rng-stream.h"
+#include "ns3/uinteger.h"
+
+#include <cmath>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("BlockNormalRandomVariable");
+
+    NS_OBJECT_ENSURE_REGISTERED(BlockNormalRandomVariable);
+
+    TypeId
+    BlockNormalRandomVariable::GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::BlockNormalRandomVariable")
+                .SetParent<NormalRandomVariable>()
+                .SetGroupName("Propagation")
+                .AddConstructor<BlockNormalRandomVariable>()
+                .AddAttribute("BlockSize",
+                              "Number of standard normals generated per refill",
+                              UintegerValue(256),
+                              MakeUintegerAccessor(&BlockNormalRandomVariable::SetBlockSize,
+                                                   &BlockNormalRandomVariable::GetBlockSize),
+                              MakeUintegerChecker<uint32_t>(2));
+        return tid;
+    }
+
+    BlockNormalRandomVariable::BlockNormalRandomVariable()
+        : m_blockSize(256),
+          m_next(0)
+    {
+    }
+
+    void
+    BlockNormalRandomVariable::SetBlockSize(uint32_t blockSize)
+    {
+        // Box-Muller hands out pairs
+        m_blockSize = blockSize + (blockSize & 1);
+    }
+
+    uint32_t
+    BlockNormalRandomVariable::GetBlockSize() const
+    {
+        return m_blockSize;
+    }
+
+    void
+    BlockNormalRandomVariable::Refill()
+    {
+        // fresh key from the MRG32k3a stream, so the block follows seed, run and stream
+        uint64_t keyHigh = static_cast<uint64_t>(Peek()->RandU01() * 4294967296.0);
+        uint64_t keyLow = static_cast<uint64_t>(Peek()->RandU01() * 4294967296.0);
+        const PhiloxRng rng(0, keyHigh << 32 | keyLow, 0);
+
+        const std::size_t pairs = m_blockSize / 2;
+        m_words.resize(4 * pairs);
+        m_buffer.resize(2 * pairs);
+
+        for (std::size_t i = 0; i < pairs; ++i)
+        {
+            rng.Generate(i, &m_words[4 * i]);
+        }
+
+        for (std::size_t i = 0; i < pairs; ++i)
+        {
+            const uint32_t *words = &m_words[4 * i];
+            double radius = std::sqrt(-2.0 * std::log(PhiloxRng::ToU01(words[0], words[1])));
+            double angle = 2.0 * M_PI * PhiloxRng::ToU01(words[2], words[3]);
+            m_buffer[2 * i] = radius * std::cos(angle);
+            m_buffer[2 * i + 1] = radius * std::sin(angle);
+        }
+        m_next = 0;
+
+        NS_LOG_LOGIC("refilled " << m_buffer.size() << " normals");
+    }
+
+    double
+    BlockNormalRandomVariable::GetValue()
+    {
+        const double mean = GetMean();
+        const double stdDev = std::sqrt(GetVariance());
+        const double bound = GetBound();
+        while (true)
+        {
+            if (m_next == m_buffer.size())
+            {
+                Refill();
+            }
+            double z = m_buffer[m_next++];
+            if (IsAntithetic())
+            {
+                z = -z;
+            }
+            // same truncation as NormalRandomVariable: redraw values outside the bound
+            double value = mean + stdDev * z;
+            if (std::fabs(value - mean) <= bound)
+            {
+                return value;
+            }
+        }
+    }
+
+    uint32_t
+    BlockNormalRandomVariable::GetInteger()
+    {
+        return static_cast<uint32_t>(GetValue());
+    }
+} // namespace ns3
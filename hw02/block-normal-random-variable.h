@@ -0,0 +1,65 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#ifndef BLOCK_NORMAL_RANDOM_VARIABLE_H
+#define BLOCK_NORMAL_RANDOM_VARIABLE_H
+
+#include "ns3/random-variable-stream.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Normal random variable that generates its variates a block at a time.
+     *
+     * Each refill draws a 64 bit key from the variable's own RngStream (two RandU01
+     * calls), then runs Philox4x32-10 over counters 0..BlockSize/2 - 1 with that key and
+     * turns the outputs into standard normals with Box-Muller. GetValue then only scales
+     * and hands out the next buffered value. The integer stage is a tight loop over
+     * independent counters, which the compiler vectorizes, and the MRG32k3a stream is
+     * touched twice per block instead of about 2.5 times per pair of samples.
+     *
+     * Results depend on seed, run and stream like any other RandomVariableStream, but
+     * the sequence differs from NormalRandomVariable. Mean, Variance, Bound and Antithetic
+     * behave as in NormalRandomVariable, so it can replace it through a PointerValue
+     * attribute, e.g. gaussRandomVar of LogNormalShadowingModel:
+     * "ns3::BlockNormalRandomVariable[Mean=0|Variance=16]"
+     *
+     * Values already buffered are still handed out after SetStream, so assign streams
+     * before the first draw, as usual.
+     */
+    class BlockNormalRandomVariable : public NormalRandomVariable
+    {
+    public:
+        static TypeId GetTypeId();
+        BlockNormalRandomVariable();
+
+        // Standard normals generated per refill (rounded up to even)
+        void SetBlockSize(uint32_t blockSize);
+        uint32_t GetBlockSize() const;
+
+        using NormalRandomVariable::GetValue;
+        double GetValue() override;
+        uint32_t GetInteger() override;
+
+    private:
+        // Fills m_buffer with a fresh block of standard normals
+        void Refill();
+
+        uint32_t m_blockSize;
+        std::vector<double> m_buffer;  // standard normals
+        std::vector<uint32_t> m_words; // Philox output of the current block
+        std::size_t m_next;            // next unused entry of m_buffer
+    };
+} // namespace ns3
+#endif
@@ -0,0 +1,347 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Coverage map generator for LogNormalShadowingModel.
+ *
+ * Place this onto the scratch folder in ns3, next to random-propagation-loss-distance-expt.cc
+ * ./ns3 run "scratch/coverage-map --apCount=50 --width=4096 --height=4096"
+ *
+ * For every pixel of a rectangular area it computes the mean rx power of the best AP
+ * (dBm), the outage probability (no AP reaches --threshold, shadowing independent per
+ * AP) and the index of the best AP. The grid is cut into square tiles that worker
+ * threads pick up one at a time and write straight into a memory-mapped raster file:
+ *
+ *   CoverageHeader (see below)
+ *   double apX, apY            x apCount
+ *   float meanRxPowerDbm       x width * height, row-major, row 0 at yMin
+ *   float outageProbability    x width * height
+ *   uint16_t bestServer        x width * height
+ *
+ * Only plain numbers taken from the model on the main thread are used by the workers,
+ * ns-3 objects are not thread-safe.
+ */
+
+#include "../src/propagation/model/log-normal-shadowing-model.h"
+#include "../src/propagation/model/path-loss-kernels.h"
+
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/// Start of the raster file, followed by the AP positions and the three planes
+struct CoverageHeader
+{
+	char magic[8];	   // "LNSCOV1"
+	uint32_t width;	   // pixels along x
+	uint32_t height;   // pixels along y
+	uint32_t apCount;
+	uint32_t reserved;
+	double xMin;
+	double yMin;
+	double xMax;
+	double yMax;
+	double txPowerDbm;
+	double thresholdDbm;
+};
+
+/// Everything a worker needs, copied out of the model beforehand
+struct CoverageParams
+{
+	PathLossParams pathLoss;
+	double refDistanceSq;	// m^2, no shadowing inside
+	double refLoss;			// dB
+	double shadowingMean;	// dB
+	double shadowingStdDev; // dB
+	double txPowerDbm;
+	double thresholdDbm;
+};
+
+/// Where the planes of the raster live in the mapping
+struct CoverageRaster
+{
+	uint32_t width;
+	uint32_t height;
+	double xMin;
+	double yMin;
+	double pixelWidth;	// m
+	double pixelHeight; // m
+	float *meanRxPowerDbm;
+	float *outageProbability;
+	uint16_t *bestServer;
+};
+
+/// Fills the pixels [x0, x1) x [y0, y1) of the raster
+static void
+ComputeTile(const CoverageParams &params,
+			const std::vector<Vector> &aps,
+			const CoverageRaster &raster,
+			uint32_t x0,
+			uint32_t x1,
+			uint32_t y0,
+			uint32_t y1)
+{
+	// an AP more than 5.5 sigma below the threshold reaches it with probability under
+	// 2e-8, its outage factor rounds to 1 in the float plane
+	const double margin = 5.5 * params.shadowingStdDev;
+	const double nearFieldDbm = params.txPowerDbm - params.refLoss;
+
+	for (uint32_t y = y0; y < y1; ++y)
+	{
+		double py = raster.yMin + (y + 0.5) * raster.pixelHeight;
+		for (uint32_t x = x0; x < x1; ++x)
+		{
+			double px = raster.xMin + (x + 0.5) * raster.pixelWidth;
+
+			double best = -std::numeric_limits<double>::infinity();
+			uint16_t bestIndex = 0;
+			double outage = 1.0;
+			for (std::size_t ap = 0; ap < aps.size(); ++ap)
+			{
+				double dx = aps[ap].x - px;
+				double dy = aps[ap].y - py;
+				double distanceSq = dx * dx + dy * dy;
+
+				double rxPowerDbm;
+				if (distanceSq < params.refDistanceSq)
+				{
+					// reference loss and no shadowing, as in DoCalcRxPower
+					rxPowerDbm = nearFieldDbm;
+					outage *= rxPowerDbm < params.thresholdDbm ? 1.0 : 0.0;
+				}
+				else
+				{
+					rxPowerDbm = params.txPowerDbm + PathLossKernel(params.pathLoss, distanceSq);
+					double mean = rxPowerDbm + params.shadowingMean;
+					// once the product is below what the float plane can hold it stays 0
+					if (outage > 0 && mean + margin > params.thresholdDbm)
+					{
+						outage *= params.shadowingStdDev > 0
+									  ? 0.5 * std::erfc((mean - params.thresholdDbm) /
+														(params.shadowingStdDev * M_SQRT2))
+									  : (mean < params.thresholdDbm ? 1.0 : 0.0);
+						if (outage < std::numeric_limits<float>::denorm_min())
+						{
+							outage = 0;
+						}
+					}
+				}
+				if (rxPowerDbm > best)
+				{
+					best = rxPowerDbm;
+					bestIndex = static_cast<uint16_t>(ap);
+				}
+			}
+
+			std::size_t pixel = static_cast<std::size_t>(y) * raster.width + x;
+			raster.meanRxPowerDbm[pixel] = static_cast<float>(best + params.shadowingMean);
+			raster.outageProbability[pixel] = static_cast<float>(outage);
+			raster.bestServer[pixel] = bestIndex;
+		}
+	}
+}
+
+/// "x,y;x,y;..." into AP positions
+static std::vector<Vector>
+ParseAps(const std::string &list)
+{
+	std::vector<Vector> aps;
+	std::istringstream is(list);
+	std::string ap;
+	while (std::getline(is, ap, ';'))
+	{
+		double x;
+		double y;
+		char comma;
+		std::istringstream fields(ap);
+		NS_ABORT_MSG_UNLESS((fields >> x >> comma >> y) && comma == ',', "bad AP position " << ap);
+		aps.push_back(Vector(x, y, 0.0));
+	}
+	return aps;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string apList = ""; // "x,y;x,y", random placement if empty
+	unsigned int apCount = 50;
+	double xMin = 0;
+	double yMin = 0;
+	double xMax = 2000;
+	double yMax = 2000;
+	uint32_t width = 4096;
+	uint32_t height = 4096;
+	uint32_t tileSize = 64;
+	unsigned int threads = 0;
+	double txPowerDbm = 15;
+	double thresholdDbm = -101;
+	double exponent = 3;
+	double variance = 16;
+	std::string output = "coverage.raster";
+
+	CommandLine cmd;
+	cmd.AddValue("aps", "AP positions as x,y;x,y;... (m), random over the area if empty", apList);
+	cmd.AddValue("apCount", "Number of randomly placed APs when --aps is empty", apCount);
+	cmd.AddValue("xMin", "Left edge of the area (m)", xMin);
+	cmd.AddValue("yMin", "Bottom edge of the area (m)", yMin);
+	cmd.AddValue("xMax", "Right edge of the area (m)", xMax);
+	cmd.AddValue("yMax", "Top edge of the area (m)", yMax);
+	cmd.AddValue("width", "Pixels along x", width);
+	cmd.AddValue("height", "Pixels along y", height);
+	cmd.AddValue("tileSize", "Tile edge in pixels, one tile per work item", tileSize);
+	cmd.AddValue("threads", "Worker threads (0 for all cores)", threads);
+	cmd.AddValue("txPower", "AP tx power (dBm)", txPowerDbm);
+	cmd.AddValue("threshold", "Rx power below which a pixel is in outage (dBm)", thresholdDbm);
+	cmd.AddValue("exponent", "Path loss exponent", exponent);
+	cmd.AddValue("variance", "Shadowing variance (dB^2)", variance);
+	cmd.AddValue("output", "Raster file to write", output);
+	cmd.Parse(argc, argv);
+
+	NS_ABORT_MSG_UNLESS(width > 0 && height > 0 && tileSize > 0, "empty grid");
+	NS_ABORT_MSG_UNLESS(xMax > xMin && yMax > yMin, "empty area");
+
+	RngSeedManager::SetSeed(3);
+
+	std::vector<Vector> aps = ParseAps(apList);
+	if (aps.empty())
+	{
+		Ptr<UniformRandomVariable> placement = CreateObject<UniformRandomVariable>();
+		placement->SetStream(0);
+		for (unsigned int i = 0; i < apCount; ++i)
+		{
+			double x = placement->GetValue(xMin, xMax);
+			double y = placement->GetValue(yMin, yMax);
+			aps.push_back(Vector(x, y, 0.0));
+		}
+	}
+	NS_ABORT_MSG_UNLESS(!aps.empty() && aps.size() <= std::numeric_limits<uint16_t>::max(),
+						"need 1 to 65535 APs");
+
+	std::ostringstream gauss;
+	gauss << "ns3::NormalRandomVariable[Mean=0|Variance=" << variance << "]";
+	Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+	model->SetAttribute("gaussRandomVar", StringValue(gauss.str()));
+	model->SetPathLossExponent(exponent);
+
+	CoverageParams params;
+	params.pathLoss =
+		MakePathLossParams(model->GetPathLossExponent(), model->GetRefDistance(), model->GetRefLoss());
+	params.refDistanceSq = model->GetRefDistance() * model->GetRefDistance();
+	params.refLoss = model->GetRefLoss();
+	params.shadowingMean = model->GetShadowingMean();
+	params.shadowingStdDev = model->GetShadowingStdDev();
+	params.txPowerDbm = txPowerDbm;
+	params.thresholdDbm = thresholdDbm;
+
+	// lay the file out and map it
+	const std::size_t pixels = static_cast<std::size_t>(width) * height;
+	const std::size_t apOffset = sizeof(CoverageHeader);
+	const std::size_t meanOffset = apOffset + aps.size() * 2 * sizeof(double);
+	const std::size_t outageOffset = meanOffset + pixels * sizeof(float);
+	const std::size_t serverOffset = outageOffset + pixels * sizeof(float);
+	const std::size_t fileSize = serverOffset + pixels * sizeof(uint16_t);
+
+	int fd = open(output.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	NS_ABORT_MSG_IF(fd < 0, "cannot open " << output << ": " << std::strerror(errno));
+	NS_ABORT_MSG_IF(ftruncate(fd, fileSize) != 0, "cannot size " << output << ": " << std::strerror(errno));
+	void *mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	NS_ABORT_MSG_IF(mapping == MAP_FAILED, "cannot map " << output << ": " << std::strerror(errno));
+	char *base = static_cast<char *>(mapping);
+
+	CoverageHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "LNSCOV1", 8);
+	header.width = width;
+	header.height = height;
+	header.apCount = static_cast<uint32_t>(aps.size());
+	header.xMin = xMin;
+	header.yMin = yMin;
+	header.xMax = xMax;
+	header.yMax = yMax;
+	header.txPowerDbm = txPowerDbm;
+	header.thresholdDbm = thresholdDbm;
+	std::memcpy(base, &header, sizeof(header));
+	for (std::size_t i = 0; i < aps.size(); ++i)
+	{
+		double position[2] = {aps[i].x, aps[i].y};
+		std::memcpy(base + apOffset + i * sizeof(position), position, sizeof(position));
+	}
+
+	CoverageRaster raster;
+	raster.width = width;
+	raster.height = height;
+	raster.xMin = xMin;
+	raster.yMin = yMin;
+	raster.pixelWidth = (xMax - xMin) / width;
+	raster.pixelHeight = (yMax - yMin) / height;
+	raster.meanRxPowerDbm = reinterpret_cast<float *>(base + meanOffset);
+	raster.outageProbability = reinterpret_cast<float *>(base + outageOffset);
+	raster.bestServer = reinterpret_cast<uint16_t *>(base + serverOffset);
+
+	const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+	const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+	const uint64_t tiles = static_cast<uint64_t>(tilesX) * tilesY;
+	unsigned int workers = threads ? threads : std::max(1U, std::thread::hardware_concurrency());
+	workers = static_cast<unsigned int>(std::min<uint64_t>(workers, tiles));
+
+	std::cout << width << "x" << height << " pixels, " << aps.size() << " APs, " << tiles << " tiles on "
+			  << workers << " threads" << std::endl;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::atomic<uint64_t> nextTile(0);
+	auto worker = [&]() {
+		for (uint64_t tile = nextTile++; tile < tiles; tile = nextTile++)
+		{
+			uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * tileSize;
+			uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * tileSize;
+			ComputeTile(params,
+						aps,
+						raster,
+						x0,
+						std::min(x0 + tileSize, width),
+						y0,
+						std::min(y0 + tileSize, height));
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < workers; ++t)
+	{
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread &thread : pool)
+	{
+		thread.join();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	NS_ABORT_MSG_IF(msync(mapping, fileSize, MS_SYNC) != 0, "cannot flush " << output);
+	munmap(mapping, fileSize);
+	close(fd);
+
+	std::cout << "wrote " << output << " (" << fileSize << " bytes) in " << elapsed << " s, "
+			  << pixels * aps.size() / elapsed << " links/s" << std::endl;
+
+	model->Dispose();
+	Simulator::Destroy();
+	return 0;
+}
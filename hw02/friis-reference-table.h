@@ -0,0 +1,123 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Header only, nothing to add to the Cmake list besides the header itself.
+ */
+
+#ifndef FRIIS_REFERENCE_TABLE_H
+#define FRIIS_REFERENCE_TABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace ns3
+{
+
+    /**
+     * Friis free-space loss at 1 m, 20 * log10(4 * pi * f / c), for every 5 MHz channel
+     * center of the 802.11 2.4, 5 and 6 GHz bands, computed at compile time.
+     *
+     * FriisReferenceLoss looks the frequency up in the table and only falls back to
+     * evaluating the formula for frequencies off the channel raster.
+     */
+    struct FriisTableEntry
+    {
+        uint32_t frequencyMhz;
+        double lossAt1mDb;
+    };
+
+    // ln(x) for x > 0, usable in constant expressions (std::log is not constexpr)
+    constexpr double
+    ConstexprLn(double x)
+    {
+        // x = m * 2^e with m in [sqrt(0.5), sqrt(2)), then ln(m) = 2 * atanh((m - 1) / (m + 1))
+        int e = 0;
+        while (x >= 1.4142135623730951)
+        {
+            x /= 2;
+            e++;
+        }
+        while (x < 0.7071067811865476)
+        {
+            x *= 2;
+            e--;
+        }
+        double s = (x - 1) / (x + 1);
+        double s2 = s * s;
+        double term = s;
+        double sum = 0;
+        for (int k = 1; k < 61; k += 2)
+        {
+            sum += term / k;
+            term *= s2;
+        }
+        return 2 * sum + e * 0.6931471805599453;
+    }
+
+    constexpr double
+    FriisLossAt1m(double frequencyHz)
+    {
+        // 20 * log10(4 * pi * f / c)
+        return 20 * ConstexprLn(4 * 3.141592653589793 * frequencyHz / 299792458.0) /
+               2.302585092994046;
+    }
+
+    // 2.4 GHz: 2412..2472 MHz and 2484 MHz, 5 GHz: 5160..5885 MHz, 6 GHz: 5955..7115 MHz
+    constexpr std::size_t FRIIS_TABLE_SIZE = 13 + 1 + 146 + 233;
+
+    constexpr std::array<FriisTableEntry, FRIIS_TABLE_SIZE>
+    MakeFriisTable()
+    {
+        std::array<FriisTableEntry, FRIIS_TABLE_SIZE> table{};
+        std::size_t i = 0;
+        auto add = [&](uint32_t frequencyMhz) {
+            table[i].frequencyMhz = frequencyMhz;
+            table[i].lossAt1mDb = FriisLossAt1m(frequencyMhz * 1e6);
+            i++;
+        };
+        for (uint32_t mhz = 2412; mhz <= 2472; mhz += 5)
+        {
+            add(mhz);
+        }
+        add(2484);
+        for (uint32_t mhz = 5160; mhz <= 5885; mhz += 5)
+        {
+            add(mhz);
+        }
+        for (uint32_t mhz = 5955; mhz <= 7115; mhz += 5)
+        {
+            add(mhz);
+        }
+        return table;
+    }
+
+    constexpr std::array<FriisTableEntry, FRIIS_TABLE_SIZE> FRIIS_TABLE = MakeFriisTable();
+
+    // Friis loss (dB) at refDistance (m) for a carrier at frequencyHz
+    inline double
+    FriisReferenceLoss(double frequencyHz, double refDistance)
+    {
+        double lossAt1m;
+        double mhz = frequencyHz / 1e6;
+        auto entry = std::lower_bound(FRIIS_TABLE.begin(),
+                                      FRIIS_TABLE.end(),
+                                      mhz,
+                                      [](const FriisTableEntry &e, double f) { return e.frequencyMhz < f; });
+        if (entry != FRIIS_TABLE.end() && entry->frequencyMhz == mhz)
+        {
+            lossAt1m = entry->lossAt1mDb;
+        }
+        else
+        {
+            lossAt1m = 20 * std::log10(4 * M_PI * frequencyHz / 299792458.0);
+        }
+        return refDistance == 1.0 ? lossAt1m : lossAt1m + 20 * std::log10(refDistance);
+    }
+} // namespace ns3
+#endif
@@ -0,0 +1,262 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Header only, nothing to add to the Cmake list besides the header itself.
+ */
+
+#ifndef LINK_TABLE_H
+#define LINK_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Open-addressing hash table keyed by a pair of pointers, used for per-link state
+     * of propagation models (the two mobility models of a link).
+     *
+     * Keys and values sit in one contiguous slot array with linear probing, so a lookup
+     * is a hash and usually a single cache line, instead of a std::map tree walk and a
+     * node allocation per link. Erase uses backward-shift deletion, no tombstones.
+     * The key is taken as given; callers that want a symmetric link order the pair.
+     *
+     * The slot array doubles when it gets half full and is halved or more when Erase or
+     * EraseIf leave it less than an eighth full, so a table emptied by eviction gives its
+     * memory back instead of staying at its peak size.
+     *
+     * Pointers to values stay valid until the next Insert, Erase or EraseIf.
+     */
+    template <typename T>
+    class LinkTable
+    {
+    public:
+        LinkTable()
+            : m_size(0)
+        {
+        }
+
+        // Value for link (a, b), or nullptr if the link is not in the table
+        T *Find(const void *a, const void *b)
+        {
+            if (m_slots.empty())
+            {
+                return nullptr;
+            }
+            for (std::size_t i = Home(a, b);; i = (i + 1) & Mask())
+            {
+                Slot &slot = m_slots[i];
+                if (slot.a == nullptr)
+                {
+                    return nullptr;
+                }
+                if (slot.a == a && slot.b == b)
+                {
+                    return &slot.value;
+                }
+            }
+        }
+
+        // Value for link (a, b), default-constructed and inserted if missing.
+        // inserted tells whether the link was new.
+        T &Insert(const void *a, const void *b, bool &inserted)
+        {
+            if ((m_size + 1) * 2 > m_slots.size())
+            {
+                Rehash(m_slots.empty() ? MIN_SLOTS : m_slots.size() * 2);
+            }
+            for (std::size_t i = Home(a, b);; i = (i + 1) & Mask())
+            {
+                Slot &slot = m_slots[i];
+                if (slot.a == nullptr)
+                {
+                    slot.a = a;
+                    slot.b = b;
+                    slot.value = T();
+                    m_size++;
+                    inserted = true;
+                    return slot.value;
+                }
+                if (slot.a == a && slot.b == b)
+                {
+                    inserted = false;
+                    return slot.value;
+                }
+            }
+        }
+
+        // Removes link (a, b), returns false if it was not there
+        bool Erase(const void *a, const void *b)
+        {
+            if (m_slots.empty())
+            {
+                return false;
+            }
+            for (std::size_t i = Home(a, b);; i = (i + 1) & Mask())
+            {
+                if (m_slots[i].a == nullptr)
+                {
+                    return false;
+                }
+                if (m_slots[i].a == a && m_slots[i].b == b)
+                {
+                    EraseSlot(i);
+                    Shrink();
+                    return true;
+                }
+            }
+        }
+
+        // Removes every link for which predicate(value) is true, returns how many went
+        template <typename Predicate>
+        std::size_t EraseIf(Predicate predicate)
+        {
+            std::size_t erased = 0;
+            std::size_t i = 0;
+            while (i < m_slots.size())
+            {
+                // a backward shift can pull an unvisited entry into slot i, so look again
+                // at the same slot after erasing
+                if (m_slots[i].a != nullptr && predicate(m_slots[i].value))
+                {
+                    EraseSlot(i);
+                    erased++;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            Shrink();
+            return erased;
+        }
+
+        // Calls function(a, b, value) for every link
+        template <typename Function>
+        void ForEach(Function function)
+        {
+            for (Slot &slot : m_slots)
+            {
+                if (slot.a != nullptr)
+                {
+                    function(slot.a, slot.b, slot.value);
+                }
+            }
+        }
+
+        void Clear()
+        {
+            std::vector<Slot>().swap(m_slots); // clear() would keep the capacity
+            m_size = 0;
+        }
+
+        std::size_t GetSize() const
+        {
+            return m_size;
+        }
+
+        // Slots allocated, a power of two or 0. Memory held is this many keys and values.
+        std::size_t GetSlotCount() const
+        {
+            return m_slots.size();
+        }
+
+    private:
+        struct Slot
+        {
+            const void *a = nullptr; // nullptr marks an empty slot
+            const void *b = nullptr;
+            T value = T();
+        };
+
+        std::size_t Mask() const
+        {
+            return m_slots.size() - 1;
+        }
+
+        std::size_t Home(const void *a, const void *b) const
+        {
+            // splitmix64 finalizer over both pointers
+            uint64_t h = reinterpret_cast<uintptr_t>(a) * 0x9E3779B97F4A7C15ULL;
+            h ^= reinterpret_cast<uintptr_t>(b) + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+            h ^= h >> 31;
+            return static_cast<std::size_t>(h) & Mask();
+        }
+
+        // Smallest slot array
+        static constexpr std::size_t MIN_SLOTS = 16;
+
+        // Moves every link into a new array of slots slots (a power of two)
+        void Rehash(std::size_t slots)
+        {
+            std::vector<Slot> old;
+            old.swap(m_slots);
+            m_slots.resize(slots);
+            m_size = 0;
+            for (Slot &slot : old)
+            {
+                if (slot.a != nullptr)
+                {
+                    bool inserted;
+                    Insert(slot.a, slot.b, inserted) = slot.value;
+                }
+            }
+        }
+
+        // Below an eighth full, rehashes to the smallest array that is at most a quarter
+        // full, so a table that refills does not grow again right away
+        void Shrink()
+        {
+            if (m_size * 8 >= m_slots.size() || m_slots.size() <= MIN_SLOTS)
+            {
+                return;
+            }
+            if (m_size == 0)
+            {
+                Clear();
+                return;
+            }
+            std::size_t slots = m_slots.size();
+            while (slots > MIN_SLOTS && m_size * 4 <= slots / 2)
+            {
+                slots /= 2;
+            }
+            Rehash(slots);
+        }
+
+        // Backward-shift deletion: pull later entries of the probe run into the hole
+        void EraseSlot(std::size_t hole)
+        {
+            std::size_t i = hole;
+            while (true)
+            {
+                i = (i + 1) & Mask();
+                Slot &slot = m_slots[i];
+                if (slot.a == nullptr)
+                {
+                    break;
+                }
+                std::size_t home = Home(slot.a, slot.b);
+                // slot i may move to the hole only if its home is not in (hole, i]
+                if (((i - home) & Mask()) >= ((i - hole) & Mask()))
+                {
+                    m_slots[hole] = slot;
+                    hole = i;
+                }
+            }
+            m_slots[hole] = Slot();
+            m_size--;
+        }
+
+        std::vector<Slot> m_slots; // power-of-two sized, at most half full
+        std::size_t m_size;        // links stored
+    };
+} // namespace ns3
+#endif
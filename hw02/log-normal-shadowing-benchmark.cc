@@ -0,0 +1,544 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Throughput benchmark for LogNormalShadowingModel.
+ *
+ * Place this onto the scratch folder in ns3, next to random-propagation-loss-distance-expt.cc
+ * Build with the optimized profile so the batch kernel gets vectorized:
+ * ./ns3 configure --build-profile=optimized --enable-examples --enable-tests
+ * ./ns3 run "scratch/log-normal-shadowing-benchmark --duration=0.5"
+ *
+ * --bench picks the measurements: batch (CalcRxPowerBatch vs CalcRxPower),
+ * grid (path loss / shadowing caches on a static grid), cull (receiver culling),
+ * kernels (the path loss kernel vs the plain log-distance formula), normal
+ * (BlockNormalRandomVariable vs NormalRandomVariable, with a KS test) or all.
+ */
+
+#include "../src/propagation/model/block-normal-random-variable.h"
+#include "../src/propagation/model/log-normal-shadowing-model.h"
+#include "../src/propagation/model/path-loss-kernels.h"
+
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/mobility-model.h"
+#include "ns3/object-factory.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+typedef std::chrono::steady_clock benchClock;
+
+/// Receivers are scattered on a ring between these radii around the transmitter (m)
+static const double minRadius = 50.0;
+static const double maxRadius = 500.0;
+
+static std::vector<Ptr<MobilityModel>>
+CreateReceivers(unsigned int count)
+{
+	std::vector<Ptr<MobilityModel>> receivers;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		// deterministic placement keeps runs comparable without touching the RNG streams
+		double angle = 2 * M_PI * i / count;
+		double radius = minRadius + (maxRadius - minRadius) * ((i * 7919) % count) / count;
+		Ptr<ConstantPositionMobilityModel> rx = CreateObject<ConstantPositionMobilityModel>();
+		rx->SetPosition(Vector(radius * std::cos(angle), radius * std::sin(angle), 1.5));
+		receivers.push_back(rx);
+	}
+	return receivers;
+}
+
+/// Returns broadcasts per second for the per-receiver CalcRxPower loop
+static double
+BenchScalar(Ptr<LogNormalShadowingModel> model,
+			Ptr<MobilityModel> tx,
+			const std::vector<Ptr<MobilityModel>> &receivers,
+			double duration,
+			double &sink)
+{
+	uint64_t broadcasts = 0;
+	benchClock::time_point start = benchClock::now();
+	double elapsed = 0;
+	do
+	{
+		for (unsigned int rep = 0; rep < 16; ++rep)
+		{
+			for (const Ptr<MobilityModel> &rx : receivers)
+			{
+				sink += model->CalcRxPower(15.0, tx, rx);
+			}
+		}
+		broadcasts += 16;
+		elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+	} while (elapsed < duration);
+	return broadcasts / elapsed;
+}
+
+/// Returns broadcasts per second for CalcRxPowerBatch
+static double
+BenchBatch(Ptr<LogNormalShadowingModel> model,
+		   Ptr<MobilityModel> tx,
+		   const std::vector<Ptr<MobilityModel>> &receivers,
+		   double duration,
+		   double &sink)
+{
+	std::vector<Vector> positions;
+	for (const Ptr<MobilityModel> &rx : receivers)
+	{
+		positions.push_back(rx->GetPosition());
+	}
+	std::vector<double> rxPowerDbm(receivers.size());
+
+	uint64_t broadcasts = 0;
+	benchClock::time_point start = benchClock::now();
+	double elapsed = 0;
+	do
+	{
+		for (unsigned int rep = 0; rep < 16; ++rep)
+		{
+			model->CalcRxPowerBatch(15.0, tx, positions.data(), positions.size(), rxPowerDbm.data());
+			sink += rxPowerDbm[0];
+		}
+		broadcasts += 16;
+		elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+	} while (elapsed < duration);
+	return broadcasts / elapsed;
+}
+
+/// Largest scalar/batch disagreement with shadowing switched off (dB)
+static double
+MaxBatchError(Ptr<LogNormalShadowingModel> model,
+			  Ptr<MobilityModel> tx,
+			  const std::vector<Ptr<MobilityModel>> &receivers)
+{
+	std::vector<Vector> positions;
+	for (const Ptr<MobilityModel> &rx : receivers)
+	{
+		positions.push_back(rx->GetPosition());
+	}
+	std::vector<double> rxPowerDbm(receivers.size());
+	model->CalcRxPowerBatch(15.0, tx, positions.data(), positions.size(), rxPowerDbm.data());
+
+	double maxError = 0;
+	for (std::size_t i = 0; i < receivers.size(); ++i)
+	{
+		maxError = std::max(maxError, std::fabs(rxPowerDbm[i] - model->CalcRxPower(15.0, tx, receivers[i])));
+	}
+	return maxError;
+}
+
+/// Link evaluations per second for all ordered pairs of a static grid
+static double
+BenchGrid(Ptr<LogNormalShadowingModel> model,
+		  const std::vector<Ptr<MobilityModel>> &nodes,
+		  double duration,
+		  double &sink)
+{
+	uint64_t rounds = 0;
+	benchClock::time_point start = benchClock::now();
+	double elapsed = 0;
+	do
+	{
+		for (const Ptr<MobilityModel> &tx : nodes)
+		{
+			for (const Ptr<MobilityModel> &rx : nodes)
+			{
+				if (tx != rx)
+				{
+					sink += model->CalcRxPower(15.0, tx, rx);
+				}
+			}
+		}
+		rounds++;
+		elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+	} while (elapsed < duration);
+	return rounds * nodes.size() * (nodes.size() - 1) / elapsed;
+}
+
+/// Log-distance gain the way GetMeanRxPower used to evaluate it, from the plain distance
+static double
+ReferencePathLoss(double exponent, double refDistance, double refLoss, double distance)
+{
+	return -refLoss - 10 * exponent * std::log10(distance / refDistance);
+}
+
+static void
+RunKernelBench(double duration, double &sink)
+{
+	const double refDistance = 1.0;
+	const double refLoss = 46.6777;
+
+	// receivers 1 m to 1 km away, as positions so both sides pay for their distance
+	std::vector<Vector> positions;
+	for (unsigned int i = 0; i < 4096; ++i)
+	{
+		double distance = 1.0 + 999.0 * ((i * 7919) % 4096) / 4096.0;
+		double angle = 2 * M_PI * i / 4096;
+		positions.push_back(Vector(distance * std::cos(angle), distance * std::sin(angle), 0.0));
+	}
+	const Vector origin(0.0, 0.0, 0.0);
+
+	std::cout << "Path loss kernel vs the log10(d / d0) formula (evaluations, 1e-9 dB tolerance)\n";
+	std::cout << std::setw(10) << "exponent" << std::setw(18) << "formula evals/s"
+			  << std::setw(18) << "kernel evals/s" << std::setw(10) << "speedup" << std::setw(14) << "max diff dB"
+			  << "\n";
+
+	const double exponents[] = {2.0, 2.5, 3.0, 3.7};
+	for (double exponent : exponents)
+	{
+		PathLossParams params = MakePathLossParams(exponent, refDistance, refLoss);
+
+		double maxDiff = 0;
+		for (const Vector &position : positions)
+		{
+			double reference = ReferencePathLoss(exponent, refDistance, refLoss, CalculateDistance(position, origin));
+			double fast = PathLossKernel(params, CalculateDistanceSquared(position, origin));
+			maxDiff = std::max(maxDiff, std::fabs(reference - fast));
+		}
+
+		double rates[2];
+		for (int useKernel = 0; useKernel < 2; ++useKernel)
+		{
+			uint64_t evaluations = 0;
+			benchClock::time_point start = benchClock::now();
+			double elapsed = 0;
+			do
+			{
+				for (unsigned int rep = 0; rep < 16; ++rep)
+				{
+					for (const Vector &position : positions)
+					{
+						sink += useKernel ? PathLossKernel(params, CalculateDistanceSquared(position, origin))
+										  : ReferencePathLoss(exponent, refDistance, refLoss,
+															  CalculateDistance(position, origin));
+					}
+				}
+				evaluations += 16 * positions.size();
+				elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+			} while (elapsed < duration);
+			rates[useKernel] = evaluations / elapsed;
+		}
+
+		std::cout << std::setw(10) << exponent << std::setw(18) << std::fixed << std::setprecision(0) << rates[0] << std::setw(18) << rates[1] << std::setw(9)
+				  << std::setprecision(2) << rates[1] / rates[0] << "x" << std::setw(14) << std::scientific
+				  << std::setprecision(2) << maxDiff << std::defaultfloat
+				  << (maxDiff < 1e-9 ? "" : "  OUT OF TOLERANCE") << "\n";
+	}
+}
+
+/// Two-sample Kolmogorov-Smirnov statistic, sorts both samples
+static double
+KsStatistic(std::vector<double> &a, std::vector<double> &b)
+{
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	double d = 0;
+	std::size_t i = 0;
+	std::size_t j = 0;
+	while (i < a.size() && j < b.size())
+	{
+		double x = std::min(a[i], b[j]);
+		while (i < a.size() && a[i] == x)
+		{
+			i++;
+		}
+		while (j < b.size() && b[j] == x)
+		{
+			j++;
+		}
+		d = std::max(d, std::fabs(static_cast<double>(i) / a.size() - static_cast<double>(j) / b.size()));
+	}
+	return d;
+}
+
+/// Asymptotic p-value of KS statistic d for effective sample size n (Numerical Recipes)
+static double
+KsPValue(double d, double n)
+{
+	double lambda = (std::sqrt(n) + 0.12 + 0.11 / std::sqrt(n)) * d;
+	double sum = 0;
+	for (int k = 1; k <= 100; ++k)
+	{
+		double term = 2 * ((k & 1) ? 1 : -1) * std::exp(-2.0 * k * k * lambda * lambda);
+		sum += term;
+		if (std::fabs(term) < 1e-12)
+		{
+			break;
+		}
+	}
+	return std::min(1.0, std::max(0.0, sum));
+}
+
+static void
+RunNormalBench(double duration, double &sink)
+{
+	const unsigned int ksSamples = 200000;
+	const char *variables[] = {"ns3::NormalRandomVariable", "ns3::BlockNormalRandomVariable"};
+
+	std::cout << "Gaussian shadowing source, Mean=0 Variance=16, through Ptr<RandomVariableStream>\n";
+	std::cout << std::setw(32) << "variable" << std::setw(18) << "samples/s" << std::setw(10) << "speedup"
+			  << "\n";
+
+	std::vector<double> samples[2];
+	double baseline = 0;
+	for (int v = 0; v < 2; ++v)
+	{
+		ObjectFactory factory;
+		factory.SetTypeId(variables[v]);
+		factory.Set("Mean", DoubleValue(0.0));
+		factory.Set("Variance", DoubleValue(16.0));
+		Ptr<RandomVariableStream> variable = factory.Create<RandomVariableStream>();
+		variable->SetStream(v);
+
+		for (unsigned int i = 0; i < ksSamples; ++i)
+		{
+			samples[v].push_back(variable->GetValue());
+		}
+
+		uint64_t drawn = 0;
+		benchClock::time_point start = benchClock::now();
+		double elapsed = 0;
+		do
+		{
+			for (unsigned int i = 0; i < 4096; ++i)
+			{
+				sink += variable->GetValue();
+			}
+			drawn += 4096;
+			elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+		} while (elapsed < duration);
+
+		double rate = drawn / elapsed;
+		if (baseline == 0)
+		{
+			baseline = rate;
+		}
+		std::cout << std::setw(32) << variables[v] << std::setw(18) << std::fixed << std::setprecision(0)
+				  << rate << std::setw(9) << std::setprecision(2) << rate / baseline << "x"
+				  << std::defaultfloat << "\n";
+	}
+
+	double d = KsStatistic(samples[0], samples[1]);
+	double p = KsPValue(d, ksSamples / 2.0);
+	std::cout << "two-sample KS over " << ksSamples << " draws each: D = " << d << ", p = " << p
+			  << (p > 0.01 ? " (same distribution at 1%)" : " (DIFFERENT DISTRIBUTIONS at 1%)") << "\n";
+}
+
+static void
+RunBatchBench(double duration, double &sink)
+{
+	Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+	model->SetPathLossExponent(3);
+
+	Ptr<ConstantPositionMobilityModel> tx = CreateObject<ConstantPositionMobilityModel>();
+	tx->SetPosition(Vector(0.0, 0.0, 1.5));
+
+	std::cout << "CalcRxPower vs CalcRxPowerBatch (calls = receiver evaluations)\n";
+	std::cout << std::setw(10) << "receivers" << std::setw(18) << "scalar calls/s" << std::setw(18)
+			  << "batch calls/s" << std::setw(10) << "speedup" << std::setw(14) << "max err dB"
+			  << "\n";
+
+	const unsigned int receiverCounts[] = {10, 100, 1000};
+	for (unsigned int count : receiverCounts)
+	{
+		std::vector<Ptr<MobilityModel>> receivers = CreateReceivers(count);
+
+		model->SetAttribute("gaussRandomVar", StringValue("ns3::NormalRandomVariable[Mean=0|Variance=0]"));
+		double maxError = MaxBatchError(model, tx, receivers);
+
+		model->SetAttribute("gaussRandomVar", StringValue("ns3::NormalRandomVariable[Mean=0|Variance=2]"));
+		double scalarRate = BenchScalar(model, tx, receivers, duration, sink) * count;
+		double batchRate = BenchBatch(model, tx, receivers, duration, sink) * count;
+
+		std::cout << std::setw(10) << count << std::setw(18) << std::fixed << std::setprecision(0)
+				  << scalarRate << std::setw(18) << batchRate << std::setw(9) << std::setprecision(2)
+				  << batchRate / scalarRate << "x" << std::setw(14) << std::scientific
+				  << std::setprecision(2) << maxError << std::defaultfloat << "\n";
+	}
+}
+
+static void
+RunGridBench(unsigned int gridNodes, double duration, double &sink)
+{
+	// square-ish grid with 20 m spacing, every node a ConstantPositionMobilityModel
+	unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(gridNodes)));
+	std::vector<Ptr<MobilityModel>> nodes;
+	for (unsigned int i = 0; i < gridNodes; ++i)
+	{
+		Ptr<ConstantPositionMobilityModel> node = CreateObject<ConstantPositionMobilityModel>();
+		node->SetPosition(Vector(20.0 * (i % side), 20.0 * (i / side), 1.5));
+		nodes.push_back(node);
+	}
+
+	struct GridCase
+	{
+		const char *name;
+		bool cachePathLoss;
+		LogNormalShadowingModel::ShadowingMode shadowingMode;
+	};
+
+	const GridCase cases[] = {
+		{"no cache", false, LogNormalShadowingModel::INDEPENDENT},
+		{"path loss cache", true, LogNormalShadowingModel::INDEPENDENT},
+		{"path loss + shadowing cache", true, LogNormalShadowingModel::LINK_CACHE},
+	};
+
+	std::cout << "Static grid of " << gridNodes << " nodes, all ordered pairs\n";
+	std::cout << std::setw(30) << "mode" << std::setw(18) << "links/s" << std::setw(10) << "speedup"
+			  << "\n";
+
+	double baseline = 0;
+	for (const GridCase &gridCase : cases)
+	{
+		Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+		model->SetPathLossExponent(3);
+		model->SetAttribute("gaussRandomVar", StringValue("ns3::NormalRandomVariable[Mean=0|Variance=2]"));
+		model->SetAttribute("CachePathLoss", BooleanValue(gridCase.cachePathLoss));
+		model->SetAttribute("ShadowingMode", EnumValue(gridCase.shadowingMode));
+
+		double rate = BenchGrid(model, nodes, duration, sink);
+		if (baseline == 0)
+		{
+			baseline = rate;
+		}
+		std::cout << std::setw(30) << gridCase.name << std::setw(18) << std::fixed
+				  << std::setprecision(0) << rate << std::setw(9) << std::setprecision(2)
+				  << rate / baseline << "x" << std::defaultfloat << "\n";
+		model->Dispose();
+	}
+}
+
+static void
+RunCullingBench(unsigned int cullNodes, double duration, double &sink)
+{
+	// receivers spread over a 3 km square, tx in the middle; with n = 3 and sigma = 4 dB
+	// the culling range at 15 dBm is a few hundred metres
+	const double side = 3000.0;
+	const double txPowerDbm = 15.0;
+	std::vector<Ptr<MobilityModel>> nodes;
+	for (unsigned int i = 0; i < cullNodes; ++i)
+	{
+		Ptr<ConstantPositionMobilityModel> node = CreateObject<ConstantPositionMobilityModel>();
+		node->SetPosition(Vector(side * ((i * 7919) % cullNodes) / cullNodes,
+								 side * ((i * 104729) % cullNodes) / cullNodes,
+								 1.5));
+		nodes.push_back(node);
+	}
+	Ptr<ConstantPositionMobilityModel> tx = CreateObject<ConstantPositionMobilityModel>();
+	tx->SetPosition(Vector(side / 2 + 0.7, side / 2 + 0.3, 1.5)); // off the receiver lattice
+
+	std::cout << "Receiver culling, " << cullNodes << " receivers, threshold -101 dBm\n";
+	std::cout << std::setw(12) << "mode" << std::setw(18) << "broadcasts/s" << std::setw(16)
+			  << "visited/bcast" << std::setw(16) << "delivered/bcast" << "\n";
+
+	double delivered[2] = {0, 0};
+	uint64_t broadcastsDone[2] = {0, 0};
+	for (int culled = 0; culled < 2; ++culled)
+	{
+		Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+		model->SetPathLossExponent(3);
+		model->SetAttribute("gaussRandomVar", StringValue("ns3::NormalRandomVariable[Mean=0|Variance=16]"));
+		model->SetAttribute("Culling", BooleanValue(culled == 1));
+		for (const Ptr<MobilityModel> &node : nodes)
+		{
+			model->AddCullingReceiver(node);
+		}
+
+		std::vector<Ptr<MobilityModel>> candidates;
+		uint64_t broadcasts = 0;
+		uint64_t visited = 0;
+		uint64_t received = 0;
+		benchClock::time_point start = benchClock::now();
+		double elapsed = 0;
+		do
+		{
+			const std::vector<Ptr<MobilityModel>> *receivers = &nodes;
+			if (culled)
+			{
+				candidates.clear();
+				model->GetCullingCandidates(tx, txPowerDbm, candidates);
+				receivers = &candidates;
+			}
+			for (const Ptr<MobilityModel> &rx : *receivers)
+			{
+				double rxPowerDbm = model->CalcRxPower(txPowerDbm, tx, rx);
+				received += rxPowerDbm >= -101.0;
+				sink += rxPowerDbm;
+			}
+			visited += receivers->size();
+			broadcasts++;
+			elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+		} while (elapsed < duration);
+
+		delivered[culled] = static_cast<double>(received) / broadcasts;
+		broadcastsDone[culled] = broadcasts;
+		std::cout << std::setw(12) << (culled ? "culled" : "all") << std::setw(18) << std::fixed
+				  << std::setprecision(0) << broadcasts / elapsed << std::setw(16)
+				  << std::setprecision(1) << static_cast<double>(visited) / broadcasts << std::setw(16)
+				  << std::setprecision(3) << delivered[culled] << std::defaultfloat << "\n";
+		model->Dispose();
+	}
+
+	// deliveries per broadcast are a sum of independent Bernoulli links, so their
+	// variance is at most the mean; compare the two runs against that
+	double stdError = std::sqrt(delivered[0] / broadcastsDone[0] + delivered[1] / broadcastsDone[1]);
+	double z = stdError > 0 ? (delivered[1] - delivered[0]) / stdError : 0;
+	std::cout << "delivery difference " << delivered[1] - delivered[0] << " per broadcast (z = " << z
+			  << (std::fabs(z) < 3 ? ", within tolerance)" : ", OUT OF TOLERANCE)") << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+	double duration = 0.5; // seconds spent on each measurement
+	std::string bench = "all";
+	unsigned int gridNodes = 500;
+	unsigned int cullNodes = 2000;
+
+	CommandLine cmd;
+	cmd.AddValue("duration", "Wall-clock seconds per measurement", duration);
+	cmd.AddValue("bench", "Measurements to run (batch, grid, cull, kernels, normal, all)", bench);
+	cmd.AddValue("gridNodes", "Number of nodes in the static grid benchmark", gridNodes);
+	cmd.AddValue("cullNodes", "Number of receivers in the culling benchmark", cullNodes);
+	cmd.Parse(argc, argv);
+
+	RngSeedManager::SetSeed(3);
+
+	double sink = 0; // keeps the optimizer from dropping the measured calls
+
+	if (bench == "kernels" || bench == "all")
+	{
+		RunKernelBench(duration, sink);
+	}
+	if (bench == "normal" || bench == "all")
+	{
+		RunNormalBench(duration, sink);
+	}
+	if (bench == "batch" || bench == "all")
+	{
+		RunBatchBench(duration, sink);
+	}
+	if (bench == "grid" || bench == "all")
+	{
+		RunGridBench(gridNodes, duration, sink);
+	}
+	if (bench == "cull" || bench == "all")
+	{
+		RunCullingBench(cullNodes, duration, sink);
+	}
+
+	std::cerr << "(checksum " << sink << ")\n";
+	Simulator::Destroy();
+	return 0;
+}
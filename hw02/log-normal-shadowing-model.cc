@@ -10,18 +10,65 @@
 
 #include "ns3/log-normal-shadowing-model.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/pointer.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
 #include "ns3/string.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 namespace ns3
 {
     NS_LOG_COMPONENT_DEFINE("LogNormalShadowingModel");
 
+    /**
+     * log10 for the batch kernel, kept free of branches and libm calls so the
+     * receiver loop in CalcRxPowerBatch gets auto-vectorized (AVX2 and up).
+     *
+     * x is split into 2^e * m with m in [sqrt(0.5), sqrt(2)) using integer ops only, then
+     * ln(m) = 2 * atanh(s), s = (m - 1) / (m + 1), from the odd series up to s^15.
+     * Absolute error is below 1e-14 for positive normal x.
+     */
+    static inline double
+    BatchLog10(double x)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        uint64_t mantissa = bits & 0x000fffffffffffffULL;
+        // fold mantissas above sqrt(2) down by one octave
+        uint64_t high = static_cast<uint64_t>(mantissa > 0x6a09e667f3bccULL);
+        uint64_t exponentBits = ((bits >> 52) + high) | 0x4330000000000000ULL;
+        uint64_t mantissaBits = mantissa | ((0x3ffULL - high) << 52);
+
+        double exponent;
+        double m;
+        std::memcpy(&exponent, &exponentBits, sizeof(exponent));
+        std::memcpy(&m, &mantissaBits, sizeof(m));
+        exponent -= 4503599627370496.0 + 1023.0; // 2^52 + exponent bias
+
+        double s = (m - 1.0) / (m + 1.0);
+        double s2 = s * s;
+        double p = 1.0 / 15.0;
+        p = p * s2 + 1.0 / 13.0;
+        p = p * s2 + 1.0 / 11.0;
+        p = p * s2 + 1.0 / 9.0;
+        p = p * s2 + 1.0 / 7.0;
+        p = p * s2 + 1.0 / 5.0;
+        p = p * s2 + 1.0 / 3.0;
+        p = p * s2 + 1.0;
+        double ln = 2.0 * s * p + exponent * M_LN2;
+        return ln * M_LOG10E;
+    }
+
     // Making implementation for the previously-created class, still using propagation-loss-model.cc
     NS_OBJECT_ENSURE_REGISTERED(LogNormalShadowingModel);
 
@@ -36,36 +83,157 @@ namespace ns3
                 .AddAttribute("pathLossExponent",
                               "The exponent of the Path Loss propagation model",
                               DoubleValue(2.5), // hard-coded to 2.5 for this hw assignment
-                              MakeDoubleAccessor(&LogNormalShadowingModel::m_pathLossExponent),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetPathLossExponent,
+                                                 &LogNormalShadowingModel::GetPathLossExponent),
                               MakeDoubleChecker<double>())
                 .AddAttribute("refDistance",
-                              "The distance at which the reference loss is calculated (m)",
+                              "The distance at which the reference loss is calculated (m). Closer "
+                              "links get the reference loss and no shadowing",
                               DoubleValue(1.0),
-                              MakeDoubleAccessor(&LogNormalShadowingModel::m_refDistance),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetRefDistance,
+                                                 &LogNormalShadowingModel::GetRefDistance),
                               MakeDoubleChecker<double>())
                 .AddAttribute("refLoss",
                               "The reference loss at reference distance (dB). (Default is Friis at 1m "
                               "with 5.15 GHz)",
                               DoubleValue(46.6777),
-                              MakeDoubleAccessor(&LogNormalShadowingModel::m_refLoss),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetRefLoss,
+                                                 &LogNormalShadowingModel::GetRefLoss),
                               MakeDoubleChecker<double>())
+                .AddAttribute("Frequency",
+                              "Carrier frequency (Hz). When nonzero, refLoss is replaced by the "
+                              "Friis loss at refDistance for this frequency",
+                              DoubleValue(0.0),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetFrequency,
+                                                 &LogNormalShadowingModel::GetFrequency),
+                              MakeDoubleChecker<double>(0.0))
                 .AddAttribute("gaussRandomVar",
                               "The random Gaussian Variable",
                               StringValue("ns3::NormalRandomVariable[Mean=0|Variance=0]"),
-                              MakePointerAccessor(&LogNormalShadowingModel::m_gaussRandomVariable),
-                              MakePointerChecker<RandomVariableStream>());
+                              MakePointerAccessor(&LogNormalShadowingModel::SetGaussRandomVariable,
+                                                  &LogNormalShadowingModel::GetGaussRandomVariable),
+                              MakePointerChecker<RandomVariableStream>())
+                .AddAttribute("CounterBasedRng",
+                              "Draw the shadowing term from a counter-based (Philox4x32-10) "
+                              "generator using the mean and variance of gaussRandomVar, so sample N "
+                              "can be computed without drawing the N-1 samples before it",
+                              BooleanValue(false),
+                              MakeBooleanAccessor(&LogNormalShadowingModel::m_counterBased),
+                              MakeBooleanChecker())
+                .AddAttribute("ShadowingMode",
+                              "Independent draws per call, one cached value per link that is "
+                              "only redrawn once an end has moved more than DecorrelationDistance, "
+                              "or a Gauss-Markov process per link with CoherenceTime",
+                              EnumValue(LogNormalShadowingModel::INDEPENDENT),
+                              MakeEnumAccessor(&LogNormalShadowingModel::m_shadowingMode),
+                              MakeEnumChecker(LogNormalShadowingModel::INDEPENDENT,
+                                              "Independent",
+                                              LogNormalShadowingModel::LINK_CACHE,
+                                              "LinkCache",
+                                              LogNormalShadowingModel::GAUSS_MARKOV,
+                                              "GaussMarkov"))
+                .AddAttribute("DecorrelationDistance",
+                              "Gudmundson decorrelation distance of the cached shadowing (m)",
+                              DoubleValue(20.0),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::m_decorrelationDistance),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("CoherenceTime",
+                              "Time constant of the GaussMarkov shadowing, the correlation after "
+                              "an elapsed time t is exp(-t / CoherenceTime)",
+                              TimeValue(Seconds(1.0)),
+                              MakeTimeAccessor(&LogNormalShadowingModel::m_coherenceTime),
+                              MakeTimeChecker())
+                .AddAttribute("LinkIdleTimeout",
+                              "GaussMarkov links not queried for this long are forgotten and "
+                              "start from a fresh draw",
+                              TimeValue(Seconds(10.0)),
+                              MakeTimeAccessor(&LogNormalShadowingModel::m_linkIdleTimeout),
+                              MakeTimeChecker())
+                .AddAttribute("CachePathLoss",
+                              "Cache the deterministic path loss of links whose ends are both "
+                              "ConstantPositionMobilityModel, until one of them reports a CourseChange. "
+                              "The model then keeps every such mobility model alive until it is disposed",
+                              BooleanValue(false),
+                              MakeBooleanAccessor(&LogNormalShadowingModel::m_cachePathLoss),
+                              MakeBooleanChecker())
+                .AddAttribute("Culling",
+                              "Return a floor power without drawing shadowing for links beyond "
+                              "the range where rx power can plausibly reach CullingThreshold",
+                              BooleanValue(false),
+                              MakeBooleanAccessor(&LogNormalShadowingModel::m_culling),
+                              MakeBooleanChecker())
+                .AddAttribute("CullingThreshold",
+                              "Rx power (dBm) below which a link is useless, e.g. the PHY "
+                              "RxSensitivity",
+                              DoubleValue(-101.0),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetCullingThreshold,
+                                                 &LogNormalShadowingModel::GetCullingThreshold),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("CullingSigmas",
+                              "Shadowing standard deviations above the mean kept as margin "
+                              "when deriving the culling range",
+                              DoubleValue(3.0),
+                              MakeDoubleAccessor(&LogNormalShadowingModel::SetCullingSigmas,
+                                                 &LogNormalShadowingModel::GetCullingSigmas),
+                              MakeDoubleChecker<double>(0.0));
 
         return tid;
     }
 
+    // Marks a counter stream that has not been picked yet
+    static const uint64_t UNASSIGNED_STREAM = std::numeric_limits<uint64_t>::max();
+
     LogNormalShadowingModel::LogNormalShadowingModel()
+        : m_pathLossExponent(2.5),
+          m_refDistance(1.0),
+          m_refLoss(46.6777),
+          m_frequency(0),
+          m_counterBased(false),
+          m_counterStream(UNASSIGNED_STREAM),
+          m_sampleIndex(0),
+          m_shadowingMode(INDEPENDENT),
+          m_decorrelationDistance(20.0),
+          m_coherenceTime(Seconds(1.0)),
+          m_linkIdleTimeout(Seconds(10.0)),
+          m_cachePathLoss(false),
+          m_pathLossGeneration(0),
+          m_culling(false),
+          m_cullingThreshold(-101.0),
+          m_cullingSigmas(3.0),
+          m_cullingTxPowerDbm(std::numeric_limits<double>::quiet_NaN()),
+          m_cullingMean(0),
+          m_cullingVariance(0),
+          m_cullingRange(0)
+    {
+        UpdatePathLossKernel();
+    }
+
+    void
+    LogNormalShadowingModel::DoDispose()
     {
+        for (Ptr<MobilityModel> mobility : m_watchedMobilityList)
+        {
+            mobility->TraceDisconnectWithoutContext("CourseChange", GetCourseChangeCallback());
+        }
+        m_watchedMobilityList.clear();
+        m_watchedMobility.Clear();
+        m_bands.Clear();
+        m_linkPathLoss.Clear();
+        m_linkShadowing.Clear();
+        m_linkGaussMarkov.Clear();
+        m_cullingIndex.reset();
+        m_cullingReceivers.clear();
+        m_cullingReceiverSet.Clear();
+        m_gaussRandomVariable = nullptr;
+        PropagationLossModel::DoDispose();
     }
 
     void
     LogNormalShadowingModel::SetPathLossExponent(double n)
     {
         m_pathLossExponent = n;
+        UpdatePathLossKernel();
+        ClearPathLossCache();
     }
 
     void
@@ -73,6 +241,99 @@ namespace ns3
     {
         m_refDistance = referenceDistance;
         m_refLoss = referenceLoss;
+        UpdatePathLossKernel();
+        ClearPathLossCache();
+    }
+
+    void
+    LogNormalShadowingModel::SetRefDistance(double refDistance)
+    {
+        m_refDistance = refDistance;
+        UpdatePathLossKernel();
+        ClearPathLossCache();
+    }
+
+    void
+    LogNormalShadowingModel::SetRefLoss(double refLoss)
+    {
+        m_refLoss = refLoss;
+        UpdatePathLossKernel();
+        ClearPathLossCache();
+    }
+
+    void
+    LogNormalShadowingModel::SetGaussRandomVariable(Ptr<RandomVariableStream> gaussRandomVariable)
+    {
+        m_gaussRandomVariable = gaussRandomVariable;
+        ClearPathLossCache();
+    }
+
+    void
+    LogNormalShadowingModel::SetFrequency(double frequencyHz)
+    {
+        m_frequency = frequencyHz;
+        UpdatePathLossKernel();
+        ClearPathLossCache();
+    }
+
+    double
+    LogNormalShadowingModel::GetFrequency() const
+    {
+        return m_frequency;
+    }
+
+    void
+    LogNormalShadowingModel::SetBand(Ptr<MobilityModel> mobility, double frequencyHz)
+    {
+        bool inserted;
+        MobilityBand &band = m_bands.Insert(PeekPointer(mobility), nullptr, inserted);
+        band.mobility = mobility;
+        band.frequency = frequencyHz;
+        UpdateBand(band);
+    }
+
+    void
+    LogNormalShadowingModel::UpdateBand(MobilityBand &band) const
+    {
+        band.refLossDelta = m_refLoss - FriisReferenceLoss(band.frequency, m_refDistance);
+        // the culling range scales by 10^(delta / (10 n)), its square by 10^(delta / (5 n))
+        band.rangeSqScale = std::pow(10.0, band.refLossDelta / (5 * m_pathLossExponent));
+    }
+
+    const LogNormalShadowingModel::MobilityBand *
+    LogNormalShadowingModel::GetBand(Ptr<MobilityModel> tx) const
+    {
+        return m_bands.GetSize() ? m_bands.Find(PeekPointer(tx), nullptr) : nullptr;
+    }
+
+    void
+    LogNormalShadowingModel::UpdatePathLossKernel()
+    {
+        if (m_frequency > 0)
+        {
+            m_refLoss = FriisReferenceLoss(m_frequency, m_refDistance);
+        }
+        // band offsets are looked up once here, not per call
+        m_bands.ForEach([this](const void *, const void *, MobilityBand &band) { UpdateBand(band); });
+        m_pathLossParams = MakePathLossParams(m_pathLossExponent, m_refDistance, m_refLoss);
+    }
+
+    Ptr<RandomVariableStream>
+    LogNormalShadowingModel::GetGaussRandomVariable() const
+    {
+        return m_gaussRandomVariable;
+    }
+
+    double
+    LogNormalShadowingModel::GetRefDistance() const
+    {
+        return m_refDistance;
+    }
+
+    double
+    LogNormalShadowingModel::GetRefLoss() const
+    {
+        return m_refLoss;
     }
 
     double
@@ -81,13 +342,18 @@ namespace ns3
         return m_pathLossExponent;
     }
 
+    bool
+    LogNormalShadowingModel::IsNearField(double distanceSq) const
+    {
+        // The original guard compared against -refDistance and never fired, which sent
+        // d < d0 through log10(d / d0) and gained power as d went to 0 (+inf at d = 0)
+        return distanceSq < m_refDistance * m_refDistance;
+    }
+
     double
-    LogNormalShadowingModel::DoCalcRxPower(double txPowerDbm,
-                                           Ptr<MobilityModel> a,
-                                           Ptr<MobilityModel> b) const
+    LogNormalShadowingModel::GetMeanRxPower(double txPowerDbm, double distance) const
     {
-        double distance = a->GetDistanceFrom(b);
-        if (distance < -m_refDistance)
+        if (IsNearField(distance * distance))
         {
             return txPowerDbm - m_refLoss;
         }
@@ -105,19 +371,560 @@ namespace ns3
          * Which becomes modified to:
          *
          * rx = rx0(tx) - 10 * n * log (d/d0)
+         *
+         * evaluated by PathLossKernel on d^2, see path-loss-kernels.h
          */
 
-        double pathlossDbm = 10 * m_pathLossExponent * std::log10(distance / m_refDistance);
-        double receivedPower = -m_refLoss - pathlossDbm;
-        double gaussLoss = m_gaussRandomVariable->GetValue();
+        double receivedPower = PathLossKernel(m_pathLossParams, distance * distance);
 
         NS_LOG_DEBUG("distance=" << distance << "m, reference-attenuation=" << -m_refLoss << "dB, "
                                  << "attenuation coefficient=" << receivedPower << "db");
-        return txPowerDbm + receivedPower + gaussLoss;
+        return txPowerDbm + receivedPower;
+    }
+
+    double
+    LogNormalShadowingModel::GetShadowingMean() const
+    {
+        Ptr<NormalRandomVariable> normal = DynamicCast<NormalRandomVariable>(m_gaussRandomVariable);
+        NS_ABORT_MSG_UNLESS(normal, "gaussRandomVar is not a NormalRandomVariable");
+        return normal->GetMean();
+    }
+
+    double
+    LogNormalShadowingModel::GetShadowingStdDev() const
+    {
+        Ptr<NormalRandomVariable> normal = DynamicCast<NormalRandomVariable>(m_gaussRandomVariable);
+        NS_ABORT_MSG_UNLESS(normal, "gaussRandomVar is not a NormalRandomVariable");
+        return std::sqrt(normal->GetVariance());
+    }
+
+    double
+    LogNormalShadowingModel::GetRxPowerPdf(double txPowerDbm,
+                                           double distance,
+                                           double rxPowerDbm) const
+    {
+        double mean = GetMeanRxPower(txPowerDbm, distance);
+        double stdDev = 0;
+        if (!IsNearField(distance * distance))
+        {
+            mean += GetShadowingMean();
+            stdDev = GetShadowingStdDev();
+        }
+        if (stdDev == 0)
+        {
+            // point mass, no density outside of it
+            return rxPowerDbm == mean ? std::numeric_limits<double>::infinity() : 0.0;
+        }
+        double z = (rxPowerDbm - mean) / stdDev;
+        return std::exp(-0.5 * z * z) / (stdDev * std::sqrt(2 * M_PI));
+    }
+
+    double
+    LogNormalShadowingModel::GetRxPowerCdf(double txPowerDbm,
+                                           double distance,
+                                           double rxPowerDbm) const
+    {
+        double mean = GetMeanRxPower(txPowerDbm, distance);
+        double stdDev = 0;
+        if (!IsNearField(distance * distance))
+        {
+            mean += GetShadowingMean();
+            stdDev = GetShadowingStdDev();
+        }
+        if (stdDev == 0)
+        {
+            return rxPowerDbm >= mean ? 1.0 : 0.0;
+        }
+        // erfc keeps full relative precision deep in the lower tail
+        return 0.5 * std::erfc((mean - rxPowerDbm) / (stdDev * M_SQRT2));
+    }
+
+    double
+    LogNormalShadowingModel::GetOutageProbability(double txPowerDbm,
+                                                  double distance,
+                                                  double thresholdDbm) const
+    {
+        // continuous distribution, so P(rx < threshold) == P(rx <= threshold)
+        return GetRxPowerCdf(txPowerDbm, distance, thresholdDbm);
+    }
+
+    double
+    LogNormalShadowingModel::DoCalcRxPower(double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+    {
+        double distanceSq;
+        double gain = GetLinkGain(a, b, distanceSq);
+        double refLoss = m_refLoss;
+        double rangeSqScale = 1;
+        // a is the transmitter in CalcRxPower, its band decides the reference loss
+        if (const MobilityBand *band = GetBand(a))
+        {
+            gain += band->refLossDelta;
+            refLoss -= band->refLossDelta;
+            rangeSqScale = band->rangeSqScale;
+        }
+        if (IsNearField(distanceSq))
+        {
+            // inside the reference distance: reference loss, no shadowing
+            return txPowerDbm - refLoss;
+        }
+        if (m_culling)
+        {
+            double range = GetCullingRange(txPowerDbm);
+            if (distanceSq > range * range * rangeSqScale)
+            {
+                return CULLED_RX_POWER_DBM;
+            }
+        }
+
+        double gaussLoss;
+        switch (m_shadowingMode)
+        {
+        case LINK_CACHE:
+            gaussLoss = GetLinkShadowing(a, b);
+            break;
+        case GAUSS_MARKOV:
+            gaussLoss = GetGaussMarkovShadowing(a, b);
+            break;
+        default:
+            gaussLoss = DrawShadowing();
+        }
+        return txPowerDbm + gain + gaussLoss;
+    }
+
+    double
+    LogNormalShadowingModel::GetLinkGain(Ptr<MobilityModel> a,
+                                         Ptr<MobilityModel> b,
+                                         double &distanceSq) const
+    {
+        if (!m_cachePathLoss)
+        {
+            distanceSq = CalculateDistanceSquared(a->GetPosition(), b->GetPosition());
+            return PathLossKernel(m_pathLossParams, distanceSq);
+        }
+
+        if (PeekPointer(b) < PeekPointer(a))
+        {
+            std::swap(a, b);
+        }
+        LinkPathLoss *cached = m_linkPathLoss.Find(PeekPointer(a), PeekPointer(b));
+        if (cached && cached->generation == m_pathLossGeneration)
+        {
+            distanceSq = cached->distanceSq;
+            return cached->gain;
+        }
+
+        distanceSq = CalculateDistanceSquared(a->GetPosition(), b->GetPosition());
+        double gain = PathLossKernel(m_pathLossParams, distanceSq);
+
+        // Only links with two static ends are cached, anything else may move without
+        // firing CourseChange on every step
+        if (!DynamicCast<ConstantPositionMobilityModel>(a) ||
+            !DynamicCast<ConstantPositionMobilityModel>(b))
+        {
+            return gain;
+        }
+        for (Ptr<MobilityModel> end : {a, b})
+        {
+            bool inserted;
+            m_watchedMobility.Insert(PeekPointer(end), nullptr, inserted);
+            if (inserted)
+            {
+                end->TraceConnectWithoutContext("CourseChange", GetCourseChangeCallback());
+                m_watchedMobilityList.push_back(end);
+            }
+        }
+
+        bool inserted;
+        LinkPathLoss &link = m_linkPathLoss.Insert(PeekPointer(a), PeekPointer(b), inserted);
+        link.distanceSq = distanceSq;
+        link.gain = gain;
+        link.generation = m_pathLossGeneration;
+        return gain;
+    }
+
+    void
+    LogNormalShadowingModel::NotifyCourseChange(Ptr<const MobilityModel> mobility) const
+    {
+        NS_LOG_LOGIC("course change, invalidating " << m_linkPathLoss.GetSize() << " cached links");
+        m_pathLossGeneration++;
+    }
+
+    Callback<void, Ptr<const MobilityModel>>
+    LogNormalShadowingModel::GetCourseChangeCallback() const
+    {
+        return MakeCallback(&LogNormalShadowingModel::NotifyCourseChange, this);
     }
+
+    void
+    LogNormalShadowingModel::ClearPathLossCache()
+    {
+        m_linkPathLoss.Clear();
+        m_pathLossGeneration++;
+        // the culling range depends on the same parameters
+        ResetCulling();
+    }
+
+    void
+    LogNormalShadowingModel::ResetCulling() const
+    {
+        m_cullingTxPowerDbm = std::numeric_limits<double>::quiet_NaN();
+        // rebuilt with a cell size matching the new range on the next query
+        m_cullingIndex.reset();
+    }
+
+    void
+    LogNormalShadowingModel::SetCullingThreshold(double thresholdDbm)
+    {
+        m_cullingThreshold = thresholdDbm;
+        ResetCulling();
+    }
+
+    double
+    LogNormalShadowingModel::GetCullingThreshold() const
+    {
+        return m_cullingThreshold;
+    }
+
+    void
+    LogNormalShadowingModel::SetCullingSigmas(double sigmas)
+    {
+        m_cullingSigmas = sigmas;
+        ResetCulling();
+    }
+
+    double
+    LogNormalShadowingModel::GetCullingSigmas() const
+    {
+        return m_cullingSigmas;
+    }
+
+    double
+    LogNormalShadowingModel::GetCullingRange(double txPowerDbm) const
+    {
+        // The shadowing moments are read on every call: Mean and Variance of
+        // gaussRandomVar can be changed on the variable itself, without going through
+        // the model
+        Ptr<NormalRandomVariable> normal = DynamicCast<NormalRandomVariable>(m_gaussRandomVariable);
+        NS_ABORT_MSG_UNLESS(normal, "gaussRandomVar is not a NormalRandomVariable");
+        double mean = normal->GetMean();
+        double variance = normal->GetVariance();
+        if (mean != m_cullingMean || variance != m_cullingVariance)
+        {
+            ResetCulling();
+            m_cullingMean = mean;
+            m_cullingVariance = variance;
+        }
+        if (txPowerDbm == m_cullingTxPowerDbm)
+        {
+            return m_cullingRange;
+        }
+
+        /**
+         * Largest plausible rx power at distance d is
+         * tx - refLoss - 10 * n * log10(d / d0) + mean + k * sigma
+         * which reaches the threshold at
+         * d = d0 * 10^((tx - refLoss + mean + k * sigma - threshold) / (10 * n))
+         */
+        double margin = txPowerDbm - m_refLoss + mean + m_cullingSigmas * std::sqrt(variance) -
+                        m_cullingThreshold;
+        m_cullingRange = m_refDistance * std::pow(10.0, margin / (10 * m_pathLossExponent));
+        m_cullingTxPowerDbm = txPowerDbm;
+
+        NS_LOG_DEBUG("culling range for " << txPowerDbm << "dBm is " << m_cullingRange << "m");
+        return m_cullingRange;
+    }
+
+    bool
+    LogNormalShadowingModel::IsCullingEnabled() const
+    {
+        return m_culling;
+    }
+
+    void
+    LogNormalShadowingModel::AddCullingReceiver(Ptr<MobilityModel> receiver)
+    {
+        bool inserted;
+        m_cullingReceiverSet.Insert(PeekPointer(receiver), nullptr, inserted);
+        if (!inserted)
+        {
+            return;
+        }
+        m_cullingReceivers.push_back(receiver);
+        if (m_cullingIndex)
+        {
+            m_cullingIndex->Add(receiver);
+        }
+    }
+
+    void
+    LogNormalShadowingModel::GetCullingCandidates(Ptr<MobilityModel> tx,
+                                                  double txPowerDbm,
+                                                  std::vector<Ptr<MobilityModel>> &candidates) const
+    {
+        double range = GetCullingRange(txPowerDbm);
+        // a grid built for another range is dropped once its cells are off by more than a
+        // factor 2: smaller cells make a query visit many more of them, larger ones hand
+        // back many receivers outside the range
+        if (m_cullingIndex)
+        {
+            double cellSize = m_cullingIndex->GetCellSize();
+            double wanted = std::max(range, 1.0);
+            if (wanted > 2 * cellSize || wanted < 0.5 * cellSize)
+            {
+                NS_LOG_DEBUG("culling range " << range << "m, rebuilding the grid of " << cellSize
+                                              << "m cells");
+                m_cullingIndex.reset();
+            }
+        }
+        if (!m_cullingIndex)
+        {
+            // one culling range per cell, so a query touches at most 3x3 cells
+            m_cullingIndex = std::make_unique<UniformGridIndex>(std::max(range, 1.0));
+            for (Ptr<MobilityModel> receiver : m_cullingReceivers)
+            {
+                m_cullingIndex->Add(receiver);
+            }
+        }
+        // the band of tx scales the range the same way it does in DoCalcRxPower
+        if (const MobilityBand *band = GetBand(tx))
+        {
+            range *= std::sqrt(band->rangeSqScale);
+        }
+        m_cullingIndex->GetWithinRange(tx->GetPosition(), range, candidates);
+    }
+
+    double
+    LogNormalShadowingModel::DrawShadowing() const
+    {
+        return m_counterBased ? GetShadowingSample(m_sampleIndex++)
+                              : m_gaussRandomVariable->GetValue();
+    }
+
+    double
+    LogNormalShadowingModel::GetLinkShadowing(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        // order the ends so a-b and b-a share one entry
+        if (PeekPointer(b) < PeekPointer(a))
+        {
+            std::swap(a, b);
+        }
+        Vector positionA = a->GetPosition();
+        Vector positionB = b->GetPosition();
+
+        bool inserted;
+        LinkShadowing &link = m_linkShadowing.Insert(PeekPointer(a), PeekPointer(b), inserted);
+        if (inserted)
+        {
+            link.a = a;
+            link.b = b;
+            link.shadowing = DrawShadowing();
+            link.positionA = positionA;
+            link.positionB = positionB;
+            return link.shadowing;
+        }
+
+        double moved = std::max(CalculateDistance(positionA, link.positionA),
+                                CalculateDistance(positionB, link.positionB));
+        if (moved <= m_decorrelationDistance)
+        {
+            return link.shadowing;
+        }
+
+        /**
+         * Gudmundson: shadowing seen after moving by delta is correlated with the old value by
+         * rho = exp(-delta / dcorr), so
+         * new = mean + rho * (old - mean) + sqrt(1 - rho^2) * (draw - mean)
+         */
+        double mean = GetShadowingMean();
+        double rho = std::exp(-moved / m_decorrelationDistance);
+        link.shadowing = mean + rho * (link.shadowing - mean) +
+                         std::sqrt(1 - rho * rho) * (DrawShadowing() - mean);
+        link.positionA = positionA;
+        link.positionB = positionB;
+
+        NS_LOG_LOGIC("link moved " << moved << "m, rho=" << rho << ", shadowing=" << link.shadowing);
+        return link.shadowing;
+    }
+
+    double
+    LogNormalShadowingModel::GetGaussMarkovShadowing(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        const Time now = Simulator::Now();
+
+        // Amortized sweep for idle links, at most once per timeout, so the table only
+        // holds links queried within the last two timeouts
+        if (now >= m_nextReclaim)
+        {
+            std::size_t dropped = m_linkGaussMarkov.EraseIf([&](const LinkGaussMarkov &link) {
+                return now - link.lastUpdate > m_linkIdleTimeout;
+            });
+            m_nextReclaim = now + m_linkIdleTimeout;
+            NS_LOG_LOGIC("dropped " << dropped << " idle links, " << m_linkGaussMarkov.GetSize()
+                                    << " left");
+        }
+
+        if (PeekPointer(b) < PeekPointer(a))
+        {
+            std::swap(a, b);
+        }
+        bool inserted;
+        LinkGaussMarkov &link = m_linkGaussMarkov.Insert(PeekPointer(a), PeekPointer(b), inserted);
+        if (inserted)
+        {
+            link.a = a;
+            link.b = b;
+            link.shadowing = DrawShadowing();
+            link.lastUpdate = now;
+            return link.shadowing;
+        }
+        if (now == link.lastUpdate)
+        {
+            return link.shadowing;
+        }
+
+        /**
+         * Sampling the AR(1) (Ornstein-Uhlenbeck) process exactly over the elapsed time:
+         * rho = exp(-elapsed / coherence time)
+         * new = mean + rho * (old - mean) + sqrt(1 - rho^2) * (draw - mean)
+         * One draw per query however long the link was idle, so idle links cost nothing.
+         */
+        double mean = GetShadowingMean();
+        double rho = std::exp(-(now - link.lastUpdate).GetSeconds() / m_coherenceTime.GetSeconds());
+        link.shadowing =
+            mean + rho * (link.shadowing - mean) + std::sqrt(1 - rho * rho) * (DrawShadowing() - mean);
+        link.lastUpdate = now;
+        return link.shadowing;
+    }
+
+    std::size_t
+    LogNormalShadowingModel::GetGaussMarkovLinkCount() const
+    {
+        return m_linkGaussMarkov.GetSize();
+    }
+
+    void
+    LogNormalShadowingModel::ClearShadowingCache()
+    {
+        m_linkShadowing.Clear();
+        m_linkGaussMarkov.Clear();
+    }
+
+    PhiloxRng
+    LogNormalShadowingModel::GetCounterRng() const
+    {
+        if (m_counterStream == UNASSIGNED_STREAM)
+        {
+            // Same convention as RandomVariableStream: the lower half of the stream
+            // numbers is handed out automatically
+            m_counterStream = RngSeedManager::GetNextStreamIndex();
+        }
+        return PhiloxRng(RngSeedManager::GetSeed(), m_counterStream, RngSeedManager::GetRun());
+    }
+
+    double
+    LogNormalShadowingModel::GetShadowingSample(uint64_t index) const
+    {
+        return GetShadowingMean() + GetShadowingStdDev() * GetCounterRng().GetNormal(index);
+    }
+
+    void
+    LogNormalShadowingModel::SetSampleIndex(uint64_t index)
+    {
+        m_sampleIndex = index;
+    }
+
+    uint64_t
+    LogNormalShadowingModel::GetSampleIndex() const
+    {
+        return m_sampleIndex;
+    }
+
+    void
+    LogNormalShadowingModel::CalcRxPowerBatch(double txPowerDbm,
+                                              Ptr<MobilityModel> tx,
+                                              const Vector *rxPositions,
+                                              std::size_t count,
+                                              double *rxPowerDbm) const
+    {
+        const Vector txPosition = tx->GetPosition();
+
+        // Same squared-distance form as PathLossKernel, with BatchLog10 in place of
+        // std::log10 so the loop vectorizes
+        const MobilityBand *band = GetBand(tx);
+        const double refLossDelta = band ? band->refLossDelta : 0.0;
+        const double slope = m_pathLossParams.slope;
+        const double offset = txPowerDbm + m_pathLossParams.offset + refLossDelta;
+        const double nearFieldDbm = txPowerDbm - m_refLoss + refLossDelta;
+        double cullingRangeSq = std::numeric_limits<double>::infinity();
+        if (m_culling)
+        {
+            double range = GetCullingRange(txPowerDbm);
+            cullingRangeSq = range * range * (band ? band->rangeSqScale : 1.0);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            double dx = rxPositions[i].x - txPosition.x;
+            double dy = rxPositions[i].y - txPosition.y;
+            double dz = rxPositions[i].z - txPosition.z;
+            rxPowerDbm[i] = dx * dx + dy * dy + dz * dz;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            rxPowerDbm[i] = offset - slope * BatchLog10(rxPowerDbm[i]);
+        }
+
+        // Shadowing terms are drawn in receiver order, the random variable stream is
+        // sequential so that branch stays scalar. Receivers inside the reference distance
+        // get the reference loss and culled receivers the floor power, both without a
+        // draw, like DoCalcRxPower; the distance tests sit here rather than in the loop
+        // above, which they would keep from vectorizing.
+        // Returns the rx power of a receiver that takes no draw, NaN for the others.
+        auto undrawn = [&](std::size_t i) {
+            double distanceSq = CalculateDistanceSquared(rxPositions[i], txPosition);
+            if (IsNearField(distanceSq))
+            {
+                return nearFieldDbm;
+            }
+            return distanceSq > cullingRangeSq ? CULLED_RX_POWER_DBM
+                                               : std::numeric_limits<double>::quiet_NaN();
+        };
+        if (m_counterBased)
+        {
+            const PhiloxRng rng = GetCounterRng();
+            const double mean = GetShadowingMean();
+            const double stdDev = GetShadowingStdDev();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                double power = undrawn(i);
+                rxPowerDbm[i] = std::isnan(power)
+                                    ? rxPowerDbm[i] + mean + stdDev * rng.GetNormal(m_sampleIndex++)
+                                    : power;
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                double power = undrawn(i);
+                rxPowerDbm[i] =
+                    std::isnan(power) ? rxPowerDbm[i] + m_gaussRandomVariable->GetValue() : power;
+            }
+        }
+
+        NS_LOG_DEBUG("batch of " << count << " receivers, tx=" << txPowerDbm << "dBm");
+    }
+
     int64_t
     LogNormalShadowingModel::DoAssignStreams(int64_t stream)
     {
-        return 0;
+        m_gaussRandomVariable->SetStream(stream);
+        // The upper half of the stream numbers is reserved for explicit assignment,
+        // the same offset RandomVariableStream::SetStream applies
+        m_counterStream = (1ULL << 63) + stream;
+        return 1;
     }
 }
\ No newline at end of file
@@ -11,11 +11,21 @@
 #ifndef LOG_NORMAL_SHADOWING_MODEL_H
 #define LOG_NORMAL_SHADOWING_MODEL_H
 
+#include "ns3/friis-reference-table.h"
+#include "ns3/link-table.h"
+#include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/path-loss-kernels.h"
+#include "ns3/philox-rng.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/uniform-grid-index.h"
+#include "ns3/vector.h"
 
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace ns3
 {
@@ -27,6 +37,14 @@ namespace ns3
         static TypeId GetTypeId(); // Returns object TypeId
         LogNormalShadowingModel();
 
+        // How the shadowing term evolves between calls on the same link
+        enum ShadowingMode
+        {
+            INDEPENDENT,  // fresh draw on every call
+            LINK_CACHE,   // one value per link, redrawn with Gudmundson correlation after movement
+            GAUSS_MARKOV  // one AR(1) process per link in time, advanced when the link is queried
+        };
+
         // Removes the copy() bit and assignment op to avoid wronguse
         LogNormalShadowingModel(const LogNormalShadowingModel &) = delete;
         LogNormalShadowingModel &operator=(const LogNormalShadowingModel &) = delete;
@@ -37,13 +55,225 @@ namespace ns3
 
         // Sets the ref path loss at a given distance
         void SetReference(double refDistance, double refLoss);
+        double GetRefDistance() const;
+        double GetRefLoss() const;
+
+        // Carrier frequency (Hz) refLoss is derived from with Friis, 0 if refLoss is set directly
+        void SetFrequency(double frequencyHz);
+        double GetFrequency() const;
+
+        // Registers the carrier frequency (Hz) a node transmits on. Links whose transmitting
+        // end is that mobility model use the Friis reference loss of the frequency instead
+        // of refLoss, so one model serves several bands. The propagation module does not
+        // see the PHY, so scripts pass it on, e.g. for a WifiPhy:
+        // model->SetBand(node->GetObject<MobilityModel>(), phy->GetFrequency() * 1e6)
+        void SetBand(Ptr<MobilityModel> mobility, double frequencyHz);
+
+        // Deterministic part of the rx power at the given distance (no shadowing term).
+        // Inside refDistance this is txPowerDbm - refLoss. Uses refLoss, not the bands.
+        double GetMeanRxPower(double txPowerDbm, double distance) const;
+
+        // Mean and standard deviation (dB) of the shadowing term, read off gaussRandomVar
+        double GetShadowingMean() const;
+        double GetShadowingStdDev() const;
+
+        // Closed-form distribution of the rx power at a fixed distance, which is Gaussian
+        // with mean GetMeanRxPower + GetShadowingMean and deviation GetShadowingStdDev.
+        // Inside refDistance there is no shadowing and the rx power is a point mass.
+        // Density (1/dB) at rxPowerDbm
+        double GetRxPowerPdf(double txPowerDbm, double distance, double rxPowerDbm) const;
+        // P(rx power <= rxPowerDbm)
+        double GetRxPowerCdf(double txPowerDbm, double distance, double rxPowerDbm) const;
+        // P(rx power < thresholdDbm), the outage probability at that sensitivity
+        double GetOutageProbability(double txPowerDbm, double distance, double thresholdDbm) const;
+
+        // Shadowing term (dB) of sample number index in counter-based mode. Pure function of
+        // seed, run, stream and index, so samples can be drawn in parallel or out of order
+        double GetShadowingSample(uint64_t index) const;
+
+        // Index of the next sample DoCalcRxPower draws in counter-based mode
+        void SetSampleIndex(uint64_t index);
+        uint64_t GetSampleIndex() const;
+
+        // Drops every cached per-link shadowing value (LINK_CACHE and GAUSS_MARKOV)
+        void ClearShadowingCache();
+
+        // Links currently holding GAUSS_MARKOV state
+        std::size_t GetGaussMarkovLinkCount() const;
+
+        // Drops every cached per-link path loss
+        void ClearPathLossCache();
+
+        // Distance (m) beyond which the rx power stays below CullingThreshold unless the
+        // shadowing exceeds its mean by more than CullingSigmas standard deviations
+        double GetCullingRange(double txPowerDbm) const;
+
+        // Whether the Culling attribute is set
+        bool IsCullingEnabled() const;
+
+        // Registers a receiver with the culling index, once however often it is passed
+        void AddCullingReceiver(Ptr<MobilityModel> receiver);
+
+        // Appends the registered receivers within GetCullingRange(txPowerDbm) of tx, scaled
+        // for the band of tx, in registration order. These are exactly the receivers
+        // DoCalcRxPower does not cull, so a channel can restrict its per-PHY loop to them,
+        // as the YansWifiChannel in yans-wifi-channel.cc next to this file does.
+        void GetCullingCandidates(Ptr<MobilityModel> tx,
+                                  double txPowerDbm,
+                                  std::vector<Ptr<MobilityModel>> &candidates) const;
+
+        // Power (dBm) returned for culled links, far below any receiver sensitivity
+        static constexpr double CULLED_RX_POWER_DBM = -1000.0;
+
+        // Batched CalcRxPower for one transmitter fanning out to many receivers.
+        // Fills rxPowerDbm[i] for each of the count positions in rxPositions, drawing the
+        // shadowing terms in receiver order so the result matches a CalcRxPower loop,
+        // Culling and the band of tx included: culled receivers get CULLED_RX_POWER_DBM
+        // and take no draw. Only this model is evaluated, any chained model set with
+        // SetNext is ignored. Receivers are plain positions here, so the shadowing is
+        // always independent.
+        void CalcRxPowerBatch(double txPowerDbm,
+                              Ptr<MobilityModel> tx,
+                              const Vector *rxPositions,
+                              std::size_t count,
+                              double *rxPowerDbm) const;
 
     private:
         // internal-use vars for loss exponent and noise variance
         double m_pathLossExponent; // Exponent provided for the model
         double m_refDistance;      // Initial distance that corresponds to Reference Path Loss
         double m_refLoss;          // Path loss at reference distance
+        PathLossParams m_pathLossParams; // Derived from the three above by UpdatePathLossKernel
+        double m_frequency;        // Hz, 0 when m_refLoss is not derived from a frequency
+
+        // Reference loss of a node registered with SetBand, relative to m_refLoss
+        struct MobilityBand
+        {
+            Ptr<MobilityModel> mobility; // held, so its address is not reused while registered
+            double frequency;            // Hz
+            double refLossDelta;         // m_refLoss - band reference loss, added to the gain (dB)
+            double rangeSqScale;         // factor on the squared culling range
+        };
+
+        // Mobility model -> band, keyed by (mobility, nullptr), until DoDispose
+        mutable LinkTable<MobilityBand> m_bands;
         Ptr<RandomVariableStream> m_gaussRandomVariable;
+        bool m_counterBased;               // Draw shadowing from PhiloxRng instead of the stream
+        mutable uint64_t m_counterStream;  // Philox stream, set by AssignStreams or on first use
+        mutable uint64_t m_sampleIndex;    // Next counter-based sample index
+
+        // Cached shadowing of one link, positions are those of the two ends at the last draw
+        struct LinkShadowing
+        {
+            Ptr<MobilityModel> a; // the two ends, held so their addresses are not reused
+            Ptr<MobilityModel> b; // by other models while the link is in the table
+            double shadowing;     // dB
+            Vector positionA;
+            Vector positionB;
+        };
+
+        ShadowingMode m_shadowingMode;
+        double m_decorrelationDistance; // Gudmundson decorrelation distance (m)
+        // Link -> shadowing. Keyed by mobility model pointers in a fixed order, so links
+        // are symmetric. Each entry holds both ends, which therefore stay alive until
+        // ClearShadowingCache or DoDispose.
+        mutable LinkTable<LinkShadowing> m_linkShadowing;
+
+        // Gauss-Markov shadowing of one link as of its last query
+        struct LinkGaussMarkov
+        {
+            Ptr<MobilityModel> a; // the two ends, held as in LinkShadowing
+            Ptr<MobilityModel> b;
+            double shadowing;     // dB
+            Time lastUpdate;
+        };
+
+        Time m_coherenceTime;   // AR(1) correlation is exp(-elapsed / m_coherenceTime)
+        Time m_linkIdleTimeout; // GAUSS_MARKOV links idle longer than this are dropped
+        mutable Time m_nextReclaim; // when the next sweep for idle links is due
+        // Link -> Gauss-Markov state, ends held until the link is dropped as idle
+        mutable LinkTable<LinkGaussMarkov> m_linkGaussMarkov;
+
+        // Cached deterministic part of a static link, valid while generation matches
+        struct LinkPathLoss
+        {
+            double distanceSq; // m^2
+            double gain;       // path loss kernel at distanceSq, dB
+            uint32_t generation;
+        };
+
+        bool m_cachePathLoss; // Cache the deterministic term of ConstantPosition links
+        // Bumped by every CourseChange of a watched mobility model and every parameter
+        // change, which invalidates all cached path losses at once
+        mutable uint32_t m_pathLossGeneration;
+        mutable LinkTable<LinkPathLoss> m_linkPathLoss;
+        // Mobility models whose CourseChange is connected to NotifyCourseChange, held until
+        // DoDispose so the connection can be undone
+        mutable LinkTable<bool> m_watchedMobility;
+        mutable std::vector<Ptr<MobilityModel>> m_watchedMobilityList;
+
+        bool m_culling;              // Skip links beyond the culling range
+        double m_cullingThreshold;   // dBm
+        double m_cullingSigmas;      // shadowing standard deviations of margin
+        mutable double m_cullingTxPowerDbm; // tx power m_cullingRange was computed for
+        mutable double m_cullingMean;       // shadowing mean m_cullingRange was computed for
+        mutable double m_cullingVariance;   // shadowing variance m_cullingRange was computed for
+        mutable double m_cullingRange;      // m
+        mutable std::unique_ptr<UniformGridIndex> m_cullingIndex; // built on first query
+        std::vector<Ptr<MobilityModel>> m_cullingReceivers;       // registered receivers
+        LinkTable<bool> m_cullingReceiverSet;                     // same, keyed (receiver, null)
+
+        void SetRefDistance(double refDistance);
+        void SetRefLoss(double refLoss);
+
+        // Links shorter than refDistance get the reference loss and no shadowing, in
+        // DoCalcRxPower, CalcRxPowerBatch, GetMeanRxPower and the analytic PDF/CDF alike
+        bool IsNearField(double distanceSq) const;
+
+        // Culling attribute accessors, a change drops the culling range and index
+        void SetCullingThreshold(double thresholdDbm);
+        double GetCullingThreshold() const;
+        void SetCullingSigmas(double sigmas);
+        double GetCullingSigmas() const;
+
+        // Forgets the culling range and the grid built for it
+        void ResetCulling() const;
+
+        // Re-derives the kernel parameters and band offsets after a parameter change
+        void UpdatePathLossKernel();
+
+        // Recomputes the offsets of a band from the current parameters
+        void UpdateBand(MobilityBand &band) const;
+
+        // Band registered for the transmitting end, nullptr if none
+        const MobilityBand *GetBand(Ptr<MobilityModel> tx) const;
+
+        void SetGaussRandomVariable(Ptr<RandomVariableStream> gaussRandomVariable);
+        Ptr<RandomVariableStream> GetGaussRandomVariable() const;
+
+        // Path loss kernel gain (dB) of link a-b, served from the cache for static links.
+        // distanceSq is set to the squared length of the link.
+        double GetLinkGain(Ptr<MobilityModel> a, Ptr<MobilityModel> b, double &distanceSq) const;
+
+        // CourseChange sink of the watched mobility models
+        void NotifyCourseChange(Ptr<const MobilityModel> mobility) const;
+        // Callback to NotifyCourseChange for connecting and disconnecting alike. Callback
+        // equality includes the constness of the bound object, so both must come from here.
+        Callback<void, Ptr<const MobilityModel>> GetCourseChangeCallback() const;
+
+        void DoDispose() override;
+
+        // Philox generator for the current seed/run and the model's stream
+        PhiloxRng GetCounterRng() const;
+
+        // One shadowing draw (dB) from the stream or the counter-based generator
+        double DrawShadowing() const;
+
+        // Shadowing (dB) of link a-b in LINK_CACHE mode
+        double GetLinkShadowing(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+        // Shadowing (dB) of link a-b in GAUSS_MARKOV mode, stepped to Simulator::Now
+        double GetGaussMarkovShadowing(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
         double DoCalcRxPower(double txPowerDbm,
                              Ptr<MobilityModel> a,
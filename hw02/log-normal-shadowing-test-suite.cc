@@ -0,0 +1,952 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the test folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/test/
+ *
+ * Don't forget to add it to the test sources in the Cmake list txt of the module:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ *
+ * ./test.py -s log-normal-shadowing
+ *
+ * Checks:
+ *  - rx power mean (z test), variance (chi-square), distribution (KS and binned
+ *    chi-square) against the closed form of the model
+ *  - near field: below refDistance the rx power is txPower - refLoss and no shadowing
+ *    sample is consumed
+ *  - reproducibility under AssignStreams, for the stream and the counter-based draws,
+ *    and CalcRxPowerBatch against a CalcRxPower loop, with and without Culling
+ *  - culling candidates match the links CalcRxPower does not cull, for a plain and a
+ *    banded transmitter
+ *  - Dispose disconnects the CourseChange sinks of CachePathLoss, moving a node after
+ *    the model is gone must not reach it (run with --grind to see a stale sink)
+ *  - GAUSS_MARKOV lag-1 correlation against exp(-lag / CoherenceTime), and links idle
+ *    for LinkIdleTimeout starting over from a fresh draw
+ *  - LINK_CACHE gives a->b and b->a the same shadowing, keeps it within
+ *    DecorrelationDistance and redraws it with exp(-moved / DecorrelationDistance)
+ *    correlation after a longer move
+ *  - LinkTable against a std::map under insert/erase churn, shrinking at 1/8 occupancy
+ *
+ * The CalcRxPower throughput check against a recorded baseline stays in
+ * log-normal-shadowing-validation, as it depends on the machine.
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/link-table.h"
+#include "ns3/log-normal-shadowing-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+static const double TX_POWER_DBM = 15.0;
+
+static Ptr<LogNormalShadowingModel>
+CreateModel(double variance)
+{
+    std::ostringstream gauss;
+    gauss << "ns3::NormalRandomVariable[Mean=0|Variance=" << variance << "]";
+    Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+    model->SetAttribute("gaussRandomVar", StringValue(gauss.str()));
+    model->SetPathLossExponent(3);
+    return model;
+}
+
+static Ptr<MobilityModel>
+CreateNode(double x)
+{
+    Ptr<ConstantPositionMobilityModel> node = CreateObject<ConstantPositionMobilityModel>();
+    node->SetPosition(Vector(x, 0.0, 0.0));
+    return node;
+}
+
+/// Asymptotic Kolmogorov distribution tail for statistic d and sample size n
+static double
+KsPValue(double d, double n)
+{
+    double lambda = (std::sqrt(n) + 0.12 + 0.11 / std::sqrt(n)) * d;
+    double sum = 0;
+    for (int k = 1; k <= 100; ++k)
+    {
+        double term = 2 * ((k & 1) ? 1 : -1) * std::exp(-2.0 * k * k * lambda * lambda);
+        sum += term;
+        if (std::fabs(term) < 1e-12)
+        {
+            break;
+        }
+    }
+    return std::min(1.0, std::max(0.0, sum));
+}
+
+/// Wilson-Hilferty normal score of a chi-square statistic with the given degrees of freedom
+static double
+ChiSquareZ(double chiSquare, double dof)
+{
+    double h = 2.0 / (9 * dof);
+    return (std::cbrt(chiSquare / dof) - (1 - h)) / std::sqrt(h);
+}
+
+/**
+ * CalcRxPower samples at one distance against the closed-form distribution of the
+ * model: mean, variance, KS and binned chi-square, each at a 4 sigma (or p = 1e-3)
+ * threshold
+ */
+class LogNormalShadowingDistributionTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingDistributionTestCase(double distance, uint64_t samples);
+
+  private:
+    void DoRun() override;
+
+    double m_distance;  // m
+    uint64_t m_samples; // rx power samples drawn
+};
+
+LogNormalShadowingDistributionTestCase::LogNormalShadowingDistributionTestCase(double distance,
+                                                                               uint64_t samples)
+    : TestCase("Rx power distribution at a fixed distance"),
+      m_distance(distance),
+      m_samples(samples)
+{
+}
+
+void
+LogNormalShadowingDistributionTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->AssignStreams(1);
+    Ptr<MobilityModel> a = CreateNode(0);
+    Ptr<MobilityModel> b = CreateNode(m_distance);
+
+    std::vector<double> rx(m_samples);
+    for (double &value : rx)
+    {
+        value = model->CalcRxPower(TX_POWER_DBM, a, b);
+    }
+
+    const double mean = model->GetMeanRxPower(TX_POWER_DBM, m_distance) + model->GetShadowingMean();
+    const double stdDev = model->GetShadowingStdDev();
+
+    double sum = 0;
+    for (double value : rx)
+    {
+        sum += value;
+    }
+    double sampleMean = sum / m_samples;
+    double sumSq = 0;
+    for (double value : rx)
+    {
+        sumSq += (value - sampleMean) * (value - sampleMean);
+    }
+    double sampleVariance = sumSq / (m_samples - 1);
+
+    double z = (sampleMean - mean) / (stdDev / std::sqrt(m_samples));
+    NS_TEST_EXPECT_MSG_LT(std::fabs(z),
+                          4,
+                          "mean at " << m_distance << "m: sample " << sampleMean << " vs " << mean
+                                     << " dBm");
+
+    double dof = m_samples - 1;
+    z = ChiSquareZ(dof * sampleVariance / (stdDev * stdDev), dof);
+    NS_TEST_EXPECT_MSG_LT(std::fabs(z),
+                          4,
+                          "variance at " << m_distance << "m: sample " << sampleVariance << " vs "
+                                         << stdDev * stdDev << " dB^2");
+
+    // KS against the model's own CDF
+    std::sort(rx.begin(), rx.end());
+    double d = 0;
+    for (std::size_t i = 0; i < rx.size(); ++i)
+    {
+        double cdf = model->GetRxPowerCdf(TX_POWER_DBM, m_distance, rx[i]);
+        d = std::max(d,
+                     std::max(cdf - static_cast<double>(i) / m_samples,
+                              static_cast<double>(i + 1) / m_samples - cdf));
+    }
+    NS_TEST_EXPECT_MSG_GT(KsPValue(d, m_samples), 1e-3, "KS at " << m_distance << "m: D = " << d);
+
+    // chi-square over 1 dB bins within 4 sigma, tails pooled into the end bins
+    std::vector<double> edges;
+    for (double edge = std::floor(mean - 4 * stdDev); edge <= std::ceil(mean + 4 * stdDev);
+         edge += 1.0)
+    {
+        edges.push_back(edge);
+    }
+    double chiSquare = 0;
+    std::size_t next = 0;
+    for (std::size_t bin = 0; bin <= edges.size(); ++bin)
+    {
+        double upper = bin < edges.size() ? edges[bin] : std::numeric_limits<double>::infinity();
+        uint64_t observed = 0;
+        while (next < rx.size() && rx[next] < upper)
+        {
+            observed++;
+            next++;
+        }
+        double below =
+            bin < edges.size() ? model->GetRxPowerCdf(TX_POWER_DBM, m_distance, upper) : 1.0;
+        double above = bin > 0 ? model->GetRxPowerCdf(TX_POWER_DBM, m_distance, edges[bin - 1]) : 0.0;
+        double expected = (below - above) * m_samples;
+        chiSquare += (observed - expected) * (observed - expected) / expected;
+    }
+    NS_TEST_EXPECT_MSG_LT(ChiSquareZ(chiSquare, edges.size()),
+                          4,
+                          "binned chi-square at " << m_distance << "m: chi2 = " << chiSquare
+                                                  << " over " << edges.size() + 1 << " bins");
+
+    model->Dispose();
+}
+
+/**
+ * Below refDistance the rx power is txPower - refLoss, with no shadowing draw, in
+ * CalcRxPower, CalcRxPowerBatch, GetMeanRxPower and the CDF
+ */
+class LogNormalShadowingNearFieldTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingNearFieldTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingNearFieldTestCase::LogNormalShadowingNearFieldTestCase()
+    : TestCase("Reference loss and no shadowing inside refDistance")
+{
+}
+
+void
+LogNormalShadowingNearFieldTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->SetAttribute("CounterBasedRng", BooleanValue(true));
+    model->AssignStreams(1);
+    Ptr<MobilityModel> a = CreateNode(0);
+    const double refDistance = model->GetRefDistance();
+    const double floor = TX_POWER_DBM - model->GetRefLoss();
+
+    for (double distance : {0.0, 0.25 * refDistance, 0.999 * refDistance})
+    {
+        NS_TEST_EXPECT_MSG_EQ(model->CalcRxPower(TX_POWER_DBM, a, CreateNode(distance)),
+                              floor,
+                              "CalcRxPower at " << distance << "m");
+        NS_TEST_EXPECT_MSG_EQ(model->GetMeanRxPower(TX_POWER_DBM, distance),
+                              floor,
+                              "GetMeanRxPower at " << distance << "m");
+        NS_TEST_EXPECT_MSG_EQ(model->GetRxPowerCdf(TX_POWER_DBM, distance, floor),
+                              1.0,
+                              "point mass in the CDF at " << distance << "m");
+        NS_TEST_EXPECT_MSG_EQ(model->GetRxPowerCdf(TX_POWER_DBM, distance, floor - 1e-9),
+                              0.0,
+                              "point mass in the CDF at " << distance << "m");
+    }
+    NS_TEST_EXPECT_MSG_EQ(model->GetSampleIndex(), 0, "shadowing sample consumed below refDistance");
+
+    double atReference = model->CalcRxPower(TX_POWER_DBM, a, CreateNode(refDistance));
+    NS_TEST_EXPECT_MSG_EQ(model->GetSampleIndex(), 1, "no shadowing sample at refDistance");
+    NS_TEST_EXPECT_MSG_NE(atReference, floor, "no shadowing at refDistance");
+
+    std::vector<Vector> positions = {Vector(0.5 * refDistance, 0, 0),
+                                     Vector(100, 0, 0),
+                                     Vector(0, 0, 0)};
+    std::vector<double> batch(positions.size());
+    model->SetSampleIndex(0);
+    model->CalcRxPowerBatch(TX_POWER_DBM, a, positions.data(), positions.size(), batch.data());
+    NS_TEST_EXPECT_MSG_EQ(batch[0], floor, "CalcRxPowerBatch inside refDistance");
+    NS_TEST_EXPECT_MSG_EQ(batch[2], floor, "CalcRxPowerBatch at distance 0");
+    NS_TEST_EXPECT_MSG_EQ(model->GetSampleIndex(), 1, "CalcRxPowerBatch drew for a near-field receiver");
+    model->Dispose();
+}
+
+/**
+ * Same streams give the same sequence and different streams different ones, for the
+ * stream and the counter-based draws, and CalcRxPowerBatch matches a CalcRxPower loop
+ * drawing from the same stream, with and without Culling
+ */
+class LogNormalShadowingReproducibilityTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingReproducibilityTestCase();
+
+  private:
+    void DoRun() override;
+
+    // First count rx powers of a fresh model with the given stream
+    static std::vector<double> DrawSequence(int64_t stream, bool counterBased, std::size_t count);
+};
+
+LogNormalShadowingReproducibilityTestCase::LogNormalShadowingReproducibilityTestCase()
+    : TestCase("AssignStreams reproducibility and batch against scalar")
+{
+}
+
+std::vector<double>
+LogNormalShadowingReproducibilityTestCase::DrawSequence(int64_t stream,
+                                                        bool counterBased,
+                                                        std::size_t count)
+{
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->SetAttribute("CounterBasedRng", BooleanValue(counterBased));
+    model->AssignStreams(stream);
+    Ptr<MobilityModel> a = CreateNode(0);
+    Ptr<MobilityModel> b = CreateNode(250);
+    std::vector<double> sequence;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sequence.push_back(model->CalcRxPower(TX_POWER_DBM, a, b));
+    }
+    model->Dispose();
+    return sequence;
+}
+
+void
+LogNormalShadowingReproducibilityTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    for (bool counterBased : {false, true})
+    {
+        NS_TEST_EXPECT_MSG_EQ((DrawSequence(7, counterBased, 100) == DrawSequence(7, counterBased, 100)),
+                              true,
+                              "same stream, different sequences (counter-based " << counterBased << ")");
+        NS_TEST_EXPECT_MSG_EQ((DrawSequence(7, counterBased, 100) != DrawSequence(8, counterBased, 100)),
+                              true,
+                              "different streams, same sequence (counter-based " << counterBased << ")");
+    }
+
+    // batch against a scalar loop drawing from the same stream
+    std::vector<Vector> positions;
+    std::vector<Ptr<MobilityModel>> receivers;
+    for (unsigned int i = 0; i < 64; ++i)
+    {
+        positions.push_back(Vector(10.0 + 7.0 * i, 3.0, 0.0));
+        Ptr<ConstantPositionMobilityModel> rx = CreateObject<ConstantPositionMobilityModel>();
+        rx->SetPosition(positions.back());
+        receivers.push_back(rx);
+    }
+    Ptr<MobilityModel> tx = CreateNode(0);
+    for (bool culling : {false, true})
+    {
+        Ptr<LogNormalShadowingModel> scalarModel = CreateModel(16);
+        Ptr<LogNormalShadowingModel> batchModel = CreateModel(16);
+        for (Ptr<LogNormalShadowingModel> model : {scalarModel, batchModel})
+        {
+            // about 100 m of culling range, so most of the receivers are culled
+            model->SetAttribute("Culling", BooleanValue(culling));
+            model->SetAttribute("CullingThreshold", DoubleValue(-80.0));
+            model->AssignStreams(3);
+        }
+        std::vector<double> batch(positions.size());
+        batchModel->CalcRxPowerBatch(TX_POWER_DBM, tx, positions.data(), positions.size(), batch.data());
+        for (std::size_t i = 0; i < receivers.size(); ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ_TOL(batch[i],
+                                      scalarModel->CalcRxPower(TX_POWER_DBM, tx, receivers[i]),
+                                      1e-9,
+                                      "batch vs scalar, receiver " << i << ", culling " << culling);
+        }
+        scalarModel->Dispose();
+        batchModel->Dispose();
+    }
+}
+
+/**
+ * GetCullingCandidates returns exactly the receivers CalcRxPower does not cull, for a
+ * transmitter on the default band and for one registered with SetBand on 2.4 GHz,
+ * whose lower reference loss gives it a longer range, at two tx powers far enough apart
+ * that the grid is rebuilt in between
+ */
+class LogNormalShadowingCullingTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingCullingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingCullingTestCase::LogNormalShadowingCullingTestCase()
+    : TestCase("Culling candidates of plain and banded transmitters")
+{
+}
+
+void
+LogNormalShadowingCullingTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->SetAttribute("Culling", BooleanValue(true));
+    model->AssignStreams(1);
+
+    // receivers every 25 m up to 1.5 km, around 514 m of range at 5.15 GHz and 855 m at
+    // 2.4 GHz
+    std::vector<Ptr<MobilityModel>> receivers;
+    for (double x = 25; x <= 1500; x += 25)
+    {
+        receivers.push_back(CreateNode(x));
+        model->AddCullingReceiver(receivers.back());
+    }
+    Ptr<MobilityModel> plain = CreateNode(0);
+    Ptr<MobilityModel> banded = CreateNode(0);
+    model->SetBand(banded, 2.4e9);
+
+    // 0 dBm has about a third of the range, so the grid is rebuilt for it
+    for (double txPowerDbm : {TX_POWER_DBM, 0.0})
+    {
+        std::size_t kept[2];
+        for (int isBanded = 0; isBanded < 2; ++isBanded)
+        {
+            Ptr<MobilityModel> tx = isBanded ? banded : plain;
+            std::vector<Ptr<MobilityModel>> candidates;
+            model->GetCullingCandidates(tx, txPowerDbm, candidates);
+            kept[isBanded] = 0;
+            for (Ptr<MobilityModel> rx : receivers)
+            {
+                bool culled = model->CalcRxPower(txPowerDbm, tx, rx) ==
+                              LogNormalShadowingModel::CULLED_RX_POWER_DBM;
+                bool candidate =
+                    std::find(candidates.begin(), candidates.end(), rx) != candidates.end();
+                kept[isBanded] += !culled;
+                NS_TEST_EXPECT_MSG_EQ(candidate,
+                                      !culled,
+                                      "receiver at " << rx->GetPosition().x << "m, banded "
+                                                     << isBanded << ", " << txPowerDbm << "dBm");
+            }
+        }
+        NS_TEST_EXPECT_MSG_GT(kept[1], kept[0], "2.4 GHz transmitter does not reach further");
+    }
+    model->Dispose();
+}
+
+/**
+ * With CachePathLoss the model connects to the CourseChange trace of both link ends.
+ * Dispose has to undo that, or moving a node after the model is freed calls into freed
+ * memory. The test frees the model and then moves its nodes; under --grind (valgrind)
+ * a sink left behind shows up as an invalid read.
+ */
+class LogNormalShadowingDisposeTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingDisposeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingDisposeTestCase::LogNormalShadowingDisposeTestCase()
+    : TestCase("Dispose disconnects the CourseChange sinks")
+{
+}
+
+void
+LogNormalShadowingDisposeTestCase::DoRun()
+{
+    Ptr<MobilityModel> a = CreateNode(0);
+    Ptr<MobilityModel> b = CreateNode(100);
+    // 0.1 dB of shadowing, so a stale path loss (9 dB off) stands out
+    Ptr<LogNormalShadowingModel> model = CreateModel(0.01);
+    model->SetAttribute("CachePathLoss", BooleanValue(true));
+    model->AssignStreams(1);
+    model->CalcRxPower(TX_POWER_DBM, a, b);
+
+    // the move invalidates the cached path loss while the model is alive
+    double before = model->GetMeanRxPower(TX_POWER_DBM, 200);
+    b->SetPosition(Vector(200, 0, 0));
+    double moved = model->CalcRxPower(TX_POWER_DBM, a, b);
+    NS_TEST_EXPECT_MSG_LT(std::fabs(moved - before),
+                          8 * model->GetShadowingStdDev(),
+                          "cached path loss not invalidated by the move");
+
+    model->Dispose();
+    model = nullptr;
+    a->SetPosition(Vector(10, 0, 0));
+    b->SetPosition(Vector(300, 0, 0));
+}
+
+/// Pearson correlation of the pairs (x[i], y[i])
+static double
+Correlation(const std::vector<double> &x, const std::vector<double> &y)
+{
+    double meanX = 0;
+    double meanY = 0;
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= x.size();
+    meanY /= y.size();
+    double sxy = 0;
+    double sxx = 0;
+    double syy = 0;
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+        sxy += (x[i] - meanX) * (y[i] - meanY);
+        sxx += (x[i] - meanX) * (x[i] - meanX);
+        syy += (y[i] - meanY) * (y[i] - meanY);
+    }
+    return sxy / std::sqrt(sxx * syy);
+}
+
+/**
+ * GAUSS_MARKOV: the shadowing of a link queried every lag seconds has lag-1 correlation
+ * exp(-lag / CoherenceTime), checked over many links at a lag below and one above the
+ * coherence time. Also checks the draws keep the configured standard deviation.
+ */
+class LogNormalShadowingGaussMarkovTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingGaussMarkovTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingGaussMarkovTestCase::LogNormalShadowingGaussMarkovTestCase()
+    : TestCase("GaussMarkov lag-1 correlation")
+{
+}
+
+void
+LogNormalShadowingGaussMarkovTestCase::DoRun()
+{
+    const std::size_t links = 2000;
+    const int steps = 10;
+    Ptr<MobilityModel> tx = CreateNode(0);
+    std::vector<Ptr<MobilityModel>> receivers;
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        receivers.push_back(CreateNode(10.0 + 0.5 * i));
+    }
+
+    for (double lag : {0.5, 2.0})
+    {
+        RngSeedManager::SetSeed(3);
+        Ptr<LogNormalShadowingModel> model = CreateModel(16);
+        model->SetAttribute("ShadowingMode", EnumValue(LogNormalShadowingModel::GAUSS_MARKOV));
+        model->SetAttribute("CoherenceTime", TimeValue(Seconds(1.0)));
+        model->AssignStreams(1);
+
+        // shadowing[step][link], the rx power less its deterministic part
+        std::vector<std::vector<double>> shadowing(steps, std::vector<double>(links));
+        for (int step = 0; step < steps; ++step)
+        {
+            Simulator::Schedule(Seconds(step * lag), [&, step]() {
+                for (std::size_t i = 0; i < links; ++i)
+                {
+                    shadowing[step][i] =
+                        model->CalcRxPower(TX_POWER_DBM, tx, receivers[i]) -
+                        model->GetMeanRxPower(TX_POWER_DBM, receivers[i]->GetPosition().x);
+                }
+            });
+        }
+        Simulator::Run();
+        Simulator::Destroy();
+
+        std::vector<double> before;
+        std::vector<double> after;
+        for (int step = 0; step + 1 < steps; ++step)
+        {
+            before.insert(before.end(), shadowing[step].begin(), shadowing[step].end());
+            after.insert(after.end(), shadowing[step + 1].begin(), shadowing[step + 1].end());
+        }
+        const double rho = std::exp(-lag / 1.0);
+        // standard error of the sample correlation over one step's worth of links, the
+        // steps are not independent of each other
+        const double tolerance = 4 * (1 - rho * rho) / std::sqrt(links);
+        NS_TEST_EXPECT_MSG_EQ_TOL(Correlation(before, after),
+                                  rho,
+                                  tolerance,
+                                  "lag-1 correlation at a lag of " << lag << "s");
+
+        double sumSq = 0;
+        for (double value : shadowing[steps - 1])
+        {
+            sumSq += value * value;
+        }
+        const double stdDev = model->GetShadowingStdDev();
+        NS_TEST_EXPECT_MSG_EQ_TOL(std::sqrt(sumSq / links),
+                                  stdDev,
+                                  4 * stdDev / std::sqrt(2.0 * links),
+                                  "standard deviation after " << steps << " steps of " << lag << "s");
+        model->Dispose();
+    }
+}
+
+/**
+ * GAUSS_MARKOV links not queried for LinkIdleTimeout are dropped on the next sweep and
+ * start over from a fresh draw, while a link kept busy carries on. With a coherence time
+ * far above the run, a carried-on link barely moves and a dropped one is uncorrelated
+ * with its old value.
+ */
+class LogNormalShadowingIdleLinkTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingIdleLinkTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingIdleLinkTestCase::LogNormalShadowingIdleLinkTestCase()
+    : TestCase("GaussMarkov links reset after LinkIdleTimeout")
+{
+}
+
+void
+LogNormalShadowingIdleLinkTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->SetAttribute("ShadowingMode", EnumValue(LogNormalShadowingModel::GAUSS_MARKOV));
+    model->SetAttribute("CoherenceTime", TimeValue(Seconds(1e6)));
+    model->SetAttribute("LinkIdleTimeout", TimeValue(Seconds(10.0)));
+    model->AssignStreams(1);
+
+    const std::size_t links = 100;
+    Ptr<MobilityModel> tx = CreateNode(0);
+    std::vector<Ptr<MobilityModel>> receivers;
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        receivers.push_back(CreateNode(50.0 + i));
+    }
+
+    std::vector<double> first(links);
+    std::vector<double> second(links);
+    std::size_t countAfterFirst = 0;
+    std::size_t countAfterSweep = 0;
+    Simulator::Schedule(Seconds(0), [&]() {
+        for (std::size_t i = 0; i < links; ++i)
+        {
+            first[i] = model->CalcRxPower(TX_POWER_DBM, tx, receivers[i]);
+        }
+        countAfterFirst = model->GetGaussMarkovLinkCount();
+    });
+    // keeps link 0 busy, the first sweep after time 0 is due at 10 s
+    Simulator::Schedule(Seconds(5), [&]() { model->CalcRxPower(TX_POWER_DBM, tx, receivers[0]); });
+    Simulator::Schedule(Seconds(15), [&]() {
+        second[0] = model->CalcRxPower(TX_POWER_DBM, tx, receivers[0]);
+        countAfterSweep = model->GetGaussMarkovLinkCount();
+        for (std::size_t i = 1; i < links; ++i)
+        {
+            second[i] = model->CalcRxPower(TX_POWER_DBM, tx, receivers[i]);
+        }
+    });
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(countAfterFirst, links, "links held after the first queries");
+    NS_TEST_EXPECT_MSG_EQ(countAfterSweep, 1, "idle links not dropped by the sweep at 15 s");
+    NS_TEST_EXPECT_MSG_EQ(model->GetGaussMarkovLinkCount(), links, "dropped links not recreated");
+    NS_TEST_EXPECT_MSG_EQ_TOL(second[0], first[0], 0.1, "busy link did not carry on");
+
+    // rho of the carried-on process over 15 s is 1 - 1.5e-5, so without the reset the
+    // correlation would be about 1
+    std::vector<double> oldValues(first.begin() + 1, first.end());
+    std::vector<double> newValues(second.begin() + 1, second.end());
+    NS_TEST_EXPECT_MSG_LT(std::fabs(Correlation(oldValues, newValues)),
+                          4 / std::sqrt(links - 1.0),
+                          "idle links kept their shadowing");
+    model->Dispose();
+}
+
+/**
+ * LINK_CACHE: a link has one shadowing value whichever end transmits, which stays put
+ * while the ends move less than DecorrelationDistance from where it was drawn, and is
+ * redrawn after a longer move with correlation exp(-moved / DecorrelationDistance) to the
+ * old value, checked over many links
+ */
+class LogNormalShadowingLinkCacheTestCase : public TestCase
+{
+  public:
+    LogNormalShadowingLinkCacheTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LogNormalShadowingLinkCacheTestCase::LogNormalShadowingLinkCacheTestCase()
+    : TestCase("LinkCache symmetry and redraw after a move")
+{
+}
+
+void
+LogNormalShadowingLinkCacheTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(3);
+    Ptr<LogNormalShadowingModel> model = CreateModel(16);
+    model->SetAttribute("ShadowingMode", EnumValue(LogNormalShadowingModel::LINK_CACHE));
+    model->SetAttribute("DecorrelationDistance", DoubleValue(20.0));
+    model->AssignStreams(1);
+
+    const std::size_t links = 2000;
+    Ptr<MobilityModel> tx = CreateNode(0);
+    std::vector<Ptr<MobilityModel>> receivers;
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        receivers.push_back(CreateNode(10.0 + 0.5 * i));
+    }
+    // Shadowing of link i with the given end transmitting, the rx power less its
+    // deterministic part
+    auto shadowing = [&](std::size_t i, bool fromTx) {
+        Ptr<MobilityModel> rx = receivers[i];
+        double rxPowerDbm = fromTx ? model->CalcRxPower(TX_POWER_DBM, tx, rx)
+                                   : model->CalcRxPower(TX_POWER_DBM, rx, tx);
+        return rxPowerDbm - model->GetMeanRxPower(TX_POWER_DBM, rx->GetDistanceFrom(tx));
+    };
+
+    std::vector<double> drawn(links);
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        drawn[i] = shadowing(i, true);
+        NS_TEST_EXPECT_MSG_EQ_TOL(shadowing(i, false),
+                                  drawn[i],
+                                  1e-9,
+                                  "b->a differs from a->b, link " << i);
+    }
+
+    // 10 m off the position of the draw, within the decorrelation distance
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        Vector position = receivers[i]->GetPosition();
+        receivers[i]->SetPosition(Vector(position.x, 10.0, 0.0));
+        NS_TEST_EXPECT_MSG_EQ_TOL(shadowing(i, false),
+                                  drawn[i],
+                                  1e-9,
+                                  "redrawn within 20 m, link " << i);
+    }
+
+    // 40 m off the position of the draw, twice the decorrelation distance
+    std::vector<double> redrawn(links);
+    std::size_t unchanged = 0;
+    for (std::size_t i = 0; i < links; ++i)
+    {
+        Vector position = receivers[i]->GetPosition();
+        receivers[i]->SetPosition(Vector(position.x, 40.0, 0.0));
+        redrawn[i] = shadowing(i, false);
+        unchanged += redrawn[i] == drawn[i];
+        NS_TEST_EXPECT_MSG_EQ_TOL(shadowing(i, true),
+                                  redrawn[i],
+                                  1e-9,
+                                  "a->b differs from b->a after the move, link " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(unchanged, 0, "links not redrawn after moving 40 m");
+    const double rho = std::exp(-40.0 / 20.0);
+    NS_TEST_EXPECT_MSG_EQ_TOL(Correlation(drawn, redrawn),
+                              rho,
+                              4 * (1 - rho * rho) / std::sqrt(links),
+                              "correlation of the redraw after moving 40 m");
+    model->Dispose();
+}
+
+/**
+ * LinkTable against a std::map under random insert and erase churn that repeatedly fills
+ * and drains the table, so probe runs wrap and backward-shift deletes move entries
+ * around. After every operation the sizes match, the slot array is at most half full and,
+ * unless at its minimum, at least an eighth full; every few hundred operations all links
+ * are looked up. Also pins the shrink to the exact erase that crosses 1/8 occupancy.
+ */
+class LinkTableChurnTestCase : public TestCase
+{
+  public:
+    LinkTableChurnTestCase();
+
+  private:
+    void DoRun() override;
+
+    // Checks table against reference: size, load bounds, and with lookups every link
+    void CheckTable(LinkTable<int> &table,
+                    const std::map<std::pair<const void *, const void *>, int> &reference,
+                    bool lookups,
+                    const std::string &when);
+
+    std::vector<char> m_ends; // link ends, only their addresses are used
+};
+
+LinkTableChurnTestCase::LinkTableChurnTestCase()
+    : TestCase("LinkTable insert, erase and shrink churn"),
+      m_ends(40)
+{
+}
+
+void
+LinkTableChurnTestCase::CheckTable(
+    LinkTable<int> &table,
+    const std::map<std::pair<const void *, const void *>, int> &reference,
+    bool lookups,
+    const std::string &when)
+{
+    const std::size_t slots = table.GetSlotCount();
+    NS_TEST_EXPECT_MSG_EQ(table.GetSize(), reference.size(), "size " << when);
+    NS_TEST_EXPECT_MSG_EQ((slots & (slots - 1)), 0, "slot count " << slots << " " << when);
+    NS_TEST_EXPECT_MSG_EQ((table.GetSize() * 2 <= slots), true, "over half full " << when);
+    NS_TEST_EXPECT_MSG_EQ((slots <= 16 || table.GetSize() * 8 >= slots),
+                          true,
+                          "under an eighth full, " << table.GetSize() << " in " << slots << " slots "
+                                                   << when);
+    if (!lookups)
+    {
+        return;
+    }
+    for (const char &a : m_ends)
+    {
+        for (const char &b : m_ends)
+        {
+            const int *value = table.Find(&a, &b);
+            auto it = reference.find(std::make_pair(&a, &b));
+            if (it == reference.end())
+            {
+                NS_TEST_EXPECT_MSG_EQ((value == nullptr), true, "erased link found " << when);
+            }
+            else
+            {
+                NS_TEST_EXPECT_MSG_EQ((value != nullptr), true, "link lost " << when);
+                if (value)
+                {
+                    NS_TEST_EXPECT_MSG_EQ(*value, it->second, "link value " << when);
+                }
+            }
+        }
+    }
+    std::size_t visited = 0;
+    table.ForEach([&](const void *a, const void *b, int value) {
+        auto it = reference.find(std::make_pair(a, b));
+        visited += it != reference.end() && it->second == value;
+    });
+    NS_TEST_EXPECT_MSG_EQ(visited, reference.size(), "ForEach " << when);
+}
+
+void
+LinkTableChurnTestCase::DoRun()
+{
+    Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable>();
+    random->SetStream(1);
+    const uint32_t ends = m_ends.size();
+    LinkTable<int> table;
+    std::map<std::pair<const void *, const void *>, int> reference;
+
+    // alternately biased towards inserts and erases, crossing the grow and shrink
+    // thresholds both ways
+    int op = 0;
+    for (int round = 0; round < 6; ++round)
+    {
+        const double insertShare = round % 2 == 0 ? 0.8 : 0.2;
+        for (int i = 0; i < 4000; ++i, ++op)
+        {
+            const void *a = &m_ends[random->GetInteger(0, ends - 1)];
+            const void *b = &m_ends[random->GetInteger(0, ends - 1)];
+            if (random->GetValue() < insertShare)
+            {
+                bool inserted;
+                table.Insert(a, b, inserted) = op;
+                bool isNew = reference.find(std::make_pair(a, b)) == reference.end();
+                NS_TEST_EXPECT_MSG_EQ(inserted, isNew, "Insert at operation " << op);
+                reference[std::make_pair(a, b)] = op;
+            }
+            else
+            {
+                bool erased = table.Erase(a, b);
+                bool present = reference.erase(std::make_pair(a, b)) == 1;
+                NS_TEST_EXPECT_MSG_EQ(erased, present, "Erase at operation " << op);
+            }
+            std::ostringstream when;
+            when << "after operation " << op;
+            CheckTable(table, reference, op % 500 == 0, when.str());
+        }
+        CheckTable(table, reference, true, "after round " + std::to_string(round));
+    }
+
+    // EraseIf takes out entries anywhere in the probe runs at once
+    std::size_t odd = 0;
+    for (auto it = reference.begin(); it != reference.end();)
+    {
+        odd += it->second % 2;
+        it = it->second % 2 ? reference.erase(it) : std::next(it);
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.EraseIf([](int value) { return value % 2 != 0; }), odd, "EraseIf");
+    CheckTable(table, reference, true, "after EraseIf");
+
+    // 1000 links take 2048 slots; erasing down to 256 keeps them, the next erase drops
+    // below an eighth and halves the array to 1024, a quarter full
+    table.Clear();
+    reference.clear();
+    std::vector<std::pair<const void *, const void *>> keys;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        keys.emplace_back(&m_ends[i % ends], &m_ends[i / ends]);
+        bool inserted;
+        table.Insert(keys.back().first, keys.back().second, inserted) = i;
+        reference[keys.back()] = i;
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetSlotCount(), 2048, "slots for 1000 links");
+    while (table.GetSize() > 256)
+    {
+        table.Erase(keys.back().first, keys.back().second);
+        reference.erase(keys.back());
+        keys.pop_back();
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetSlotCount(), 2048, "shrunk at exactly an eighth full");
+    table.Erase(keys.back().first, keys.back().second);
+    reference.erase(keys.back());
+    keys.pop_back();
+    NS_TEST_EXPECT_MSG_EQ(table.GetSlotCount(), 1024, "not shrunk below an eighth full");
+    CheckTable(table, reference, true, "after the shrink");
+
+    for (const auto &key : keys)
+    {
+        table.Erase(key.first, key.second);
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetSlotCount(), 0, "memory kept by an empty table");
+    bool inserted;
+    table.Insert(&m_ends[0], &m_ends[1], inserted) = 1;
+    NS_TEST_EXPECT_MSG_EQ((table.Find(&m_ends[0], &m_ends[1]) && inserted), true, "reuse after emptying");
+}
+
+/**
+ * LogNormalShadowingModel test suite
+ */
+class LogNormalShadowingTestSuite : public TestSuite
+{
+  public:
+    LogNormalShadowingTestSuite();
+};
+
+LogNormalShadowingTestSuite::LogNormalShadowingTestSuite()
+    : TestSuite("log-normal-shadowing", UNIT)
+{
+    for (double distance : {50.0, 200.0, 400.0})
+    {
+        AddTestCase(new LogNormalShadowingDistributionTestCase(distance, 20000), TestCase::QUICK);
+    }
+    AddTestCase(new LogNormalShadowingNearFieldTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingReproducibilityTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingCullingTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingDisposeTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingGaussMarkovTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingIdleLinkTestCase, TestCase::QUICK);
+    AddTestCase(new LogNormalShadowingLinkCacheTestCase, TestCase::QUICK);
+    AddTestCase(new LinkTableChurnTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static LogNormalShadowingTestSuite g_logNormalShadowingTestSuite;
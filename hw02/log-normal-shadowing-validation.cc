@@ -0,0 +1,131 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Performance check for LogNormalShadowingModel.
+ *
+ * Place this onto the scratch folder in ns3, next to random-propagation-loss-distance-expt.cc
+ * ./ns3 run "scratch/log-normal-shadowing-validation --record"   (once, stores the baseline)
+ * ./ns3 run scratch/log-normal-shadowing-validation
+ *
+ * Measures CalcRxPower throughput against the baseline file, failing on a drop of more
+ * than --tolerance percent. Prints a PASS/FAIL line and exits with the number of
+ * failures, so it can gate a build script. The statistical, near-field and
+ * reproducibility checks are in log-normal-shadowing-test-suite.cc
+ * (./test.py -s log-normal-shadowing).
+ */
+
+#include "../src/propagation/model/log-normal-shadowing-model.h"
+
+#include "ns3/command-line.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+static const double txPowerDbm = 15.0;
+static unsigned int failures = 0;
+
+static void
+Check(bool passed, const std::string &name, const std::string &detail)
+{
+	std::cout << (passed ? "PASS " : "FAIL ") << name << ": " << detail << std::endl;
+	failures += !passed;
+}
+
+/// CalcRxPower calls per second from the origin over a ring of static receivers
+static double
+MeasureThroughput(double duration)
+{
+	// same model as the baseline was recorded with
+	Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+	model->SetAttribute("gaussRandomVar", StringValue("ns3::NormalRandomVariable[Mean=0|Variance=16]"));
+	model->SetPathLossExponent(3);
+	Ptr<MobilityModel> tx = CreateObject<ConstantPositionMobilityModel>();
+	std::vector<Ptr<MobilityModel>> receivers;
+	for (unsigned int i = 0; i < 1000; ++i)
+	{
+		double angle = 2 * M_PI * i / 1000;
+		Ptr<ConstantPositionMobilityModel> rx = CreateObject<ConstantPositionMobilityModel>();
+		rx->SetPosition(Vector(300 * std::cos(angle), 300 * std::sin(angle), 0.0));
+		receivers.push_back(rx);
+	}
+
+	double sink = 0;
+	uint64_t calls = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double elapsed = 0;
+	do
+	{
+		for (const Ptr<MobilityModel> &rx : receivers)
+		{
+			sink += model->CalcRxPower(txPowerDbm, tx, rx);
+		}
+		calls += receivers.size();
+		elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while (elapsed < duration);
+	model->Dispose();
+
+	std::cerr << "(checksum " << sink << ")\n";
+	return calls / elapsed;
+}
+
+static void
+CheckThroughput(const std::string &baselineFile, bool record, double tolerance, double duration)
+{
+	double rate = MeasureThroughput(duration);
+	if (record)
+	{
+		std::ofstream out(baselineFile);
+		out << "calls_per_second " << rate << "\n";
+		std::cout << "recorded baseline " << rate << " calls/s in " << baselineFile << std::endl;
+		return;
+	}
+
+	std::ifstream in(baselineFile);
+	std::string key;
+	double baseline = 0;
+	if (!(in >> key >> baseline) || key != "calls_per_second" || baseline <= 0)
+	{
+		std::cout << "SKIP throughput: no baseline in " << baselineFile << ", run with --record" << std::endl;
+		return;
+	}
+
+	std::ostringstream detail;
+	double change = 100 * (rate / baseline - 1);
+	detail << rate << " calls/s vs baseline " << baseline << " (" << change << "%, limit -" << tolerance
+		   << "%)";
+	Check(change >= -tolerance, "throughput", detail.str());
+}
+
+int main(int argc, char *argv[])
+{
+	std::string baseline = "log-normal-shadowing-baseline.txt";
+	bool record = false;
+	double tolerance = 20; // percent
+	double duration = 1.0; // seconds of throughput measurement
+
+	CommandLine cmd;
+	cmd.AddValue("baseline", "File holding the calls-per-second baseline", baseline);
+	cmd.AddValue("record", "Measure and store the throughput baseline instead of checking it", record);
+	cmd.AddValue("tolerance", "Throughput drop (percent) below the baseline that fails", tolerance);
+	cmd.AddValue("duration", "Wall-clock seconds of throughput measurement", duration);
+	cmd.Parse(argc, argv);
+
+	RngSeedManager::SetSeed(3);
+
+	CheckThroughput(baseline, record, tolerance, duration);
+
+	std::cout << (failures ? "FAILED " : "all passed ") << "(" << failures << " failures)" << std::endl;
+	Simulator::Destroy();
+	return static_cast<int>(failures);
+}
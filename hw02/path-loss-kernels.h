@@ -0,0 +1,50 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Header only, nothing to add to the Cmake list besides the header itself.
+ */
+
+#ifndef PATH_LOSS_KERNELS_H
+#define PATH_LOSS_KERNELS_H
+
+#include <cmath>
+
+namespace ns3
+{
+
+    /**
+     * Path-loss evaluator for LogNormalShadowingModel.
+     *
+     * The log-distance gain -refLoss - 10 * n * log10(d / d0) is rewritten on the squared
+     * distance as offset - slope * log10(d^2), with slope = 5 * n and
+     * offset = -refLoss + 10 * n * log10(d0) computed once when the parameters change.
+     * That drops the sqrt in GetDistanceFrom and the division by d0 from every call.
+     * PathLossKernel is a plain inline function, so it inlines at every call site; what
+     * is left per call is one log10, one multiply and one subtraction.
+     */
+    struct PathLossParams
+    {
+        double slope;    // 5 * n
+        double offset;   // -refLoss + 10 * n * log10(refDistance), dB
+    };
+
+    // Gain (dB, negative) at squared distance distanceSq (m^2)
+    inline double
+    PathLossKernel(const PathLossParams &params, double distanceSq)
+    {
+        return params.offset - params.slope * std::log10(distanceSq);
+    }
+
+    inline PathLossParams
+    MakePathLossParams(double exponent, double refDistance, double refLoss)
+    {
+        PathLossParams params;
+        params.slope = 5 * exponent;
+        params.offset = -refLoss + 10 * exponent * std::log10(refDistance);
+        return params;
+    }
+} // namespace ns3
+#endif
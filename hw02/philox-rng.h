@@ -0,0 +1,89 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Header only, nothing to add to the Cmake list besides the header itself.
+ */
+
+#ifndef PHILOX_RNG_H
+#define PHILOX_RNG_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace ns3
+{
+
+    /**
+     * Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers:
+     * as easy as 1, 2, 3", SC'11).
+     *
+     * Output block n is a pure function of (key, n), so draw n can be computed directly
+     * without stepping through the n - 1 draws before it. The key is built from the
+     * ns-3 seed and stream number, the run number goes into the upper counter words,
+     * which mirrors how RngStream uses streams and substreams.
+     */
+    class PhiloxRng
+    {
+    public:
+        PhiloxRng(uint32_t seed, uint64_t stream, uint64_t run)
+            : m_key{static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32) ^ seed},
+              m_run(run)
+        {
+        }
+
+        // Fills out[0..3] with block number counter
+        void Generate(uint64_t counter, uint32_t out[4]) const
+        {
+            uint32_t ctr[4] = {static_cast<uint32_t>(counter),
+                               static_cast<uint32_t>(counter >> 32),
+                               static_cast<uint32_t>(m_run),
+                               static_cast<uint32_t>(m_run >> 32)};
+            uint32_t key[2] = {m_key[0], m_key[1]};
+            for (int round = 0; round < 10; ++round)
+            {
+                uint64_t product0 = static_cast<uint64_t>(0xD2511F53U) * ctr[0];
+                uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57U) * ctr[2];
+                uint32_t next[4] = {static_cast<uint32_t>(product1 >> 32) ^ ctr[1] ^ key[0],
+                                    static_cast<uint32_t>(product1),
+                                    static_cast<uint32_t>(product0 >> 32) ^ ctr[3] ^ key[1],
+                                    static_cast<uint32_t>(product0)};
+                ctr[0] = next[0];
+                ctr[1] = next[1];
+                ctr[2] = next[2];
+                ctr[3] = next[3];
+                key[0] += 0x9E3779B9U;
+                key[1] += 0xBB67AE85U;
+            }
+            out[0] = ctr[0];
+            out[1] = ctr[1];
+            out[2] = ctr[2];
+            out[3] = ctr[3];
+        }
+
+        // Uniform in (0, 1) with 53 random bits
+        static double ToU01(uint32_t high, uint32_t low)
+        {
+            uint64_t bits = (static_cast<uint64_t>(high) << 32 | low) >> 11;
+            return (bits + 0.5) * (1.0 / 9007199254740992.0);
+        }
+
+        // Standard normal number index. Box-Muller on block index / 2 gives a pair,
+        // even indices take the cosine branch and odd ones the sine branch.
+        double GetNormal(uint64_t index) const
+        {
+            uint32_t block[4];
+            Generate(index >> 1, block);
+            double radius = std::sqrt(-2.0 * std::log(ToU01(block[0], block[1])));
+            double angle = 2.0 * M_PI * ToU01(block[2], block[3]);
+            return radius * ((index & 1) ? std::sin(angle) : std::cos(angle));
+        }
+
+    private:
+        uint32_t m_key[2]; // seed and stream
+        uint64_t m_run;    // run number, upper half of the counter
+    };
+} // namespace ns3
+#endif
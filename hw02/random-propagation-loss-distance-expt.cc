@@ -20,7 +20,9 @@
  */
 
 #include "../src/propagation/model/log-normal-shadowing-model.h"
+#include "../src/propagation/model/rx-power-sampler.h"
 
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
 #include "ns3/command-line.h"
 #include "ns3/config.h"
@@ -30,80 +32,292 @@
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/pointer.h"
-#include "ns3/propagation-cache.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
-#include <map>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
-/// Round a double number to the given number of decimal places/sig-figs
-/// e.g. dround(0.69420, 0.1) => 0.7
-static double
-dround(double number, double precision)
+static Gnuplot2dDataset
+TestProbabilistic(Ptr<LogNormalShadowingModel> model,
+				  const RxPowerSampler &sampler,
+				  double distance,
+				  uint64_t samples = 1000,
+				  bool throughModel = false)
 {
-	number /= precision;
-	if (number >= 0)
+	double txPowerDbm = +15; // dBm
+
+	if (throughModel)
 	{
-		number = floor(number + 0.5);
+		// Every sample comes from CalcRxPower() on one thread, so the model's own
+		// path (near field, bands, culling, shadowing mode) is what gets plotted.
+		// The simulator advances 10 ms between samples, as time-correlated
+		// shadowing needs.
+		Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+		Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+		a->SetPosition(Vector(0.0, 0.0, 0.0));
+		b->SetPosition(Vector(distance, 0.0, 0.0));
+
+		RxPowerHistogram histogram =
+			RxPowerHistogram::Centered(model->GetMeanRxPower(txPowerDbm, distance) + model->GetShadowingMean(),
+									   std::max(8 * model->GetShadowingStdDev(), 1.0),
+									   1.0);
+		for (uint64_t samp = 0; samp < samples; ++samp)
+		{
+			// CalcRxPower() returns dBm.
+			histogram.Add(model->CalcRxPower(txPowerDbm, a, b));
+
+			Simulator::Stop(Seconds(0.01));
+			Simulator::Run();
+		}
+		return histogram.ToDataset();
 	}
-	else
+
+	// Take given number of samples of the rx power and show probability
+	// density for discrete distances, in 1 dB bins centered on whole dBm values.
+	// The deterministic part comes from the model, the shadowing draws are spread
+	// over the sampler's worker threads.
+	RxPowerHistogram histogram = sampler.Sample(model->GetMeanRxPower(txPowerDbm, distance),
+												model->GetShadowingMean(),
+												model->GetShadowingStdDev(),
+												samples,
+												1.0);
+
+	return histogram.ToDataset();
+}
+
+/// Exact probability of each 1 dB bin used by TestProbabilistic, from the model's CDF,
+/// over +-6 standard deviations around the mean
+static Gnuplot2dDataset
+TestAnalytic(Ptr<LogNormalShadowingModel> model, double distance)
+{
+	double txPowerDbm = +15; // dBm, same as TestProbabilistic
+	double mean = model->GetMeanRxPower(txPowerDbm, distance) + model->GetShadowingMean();
+	double halfSpan = std::max(6 * model->GetShadowingStdDev(), 1.0);
+
+	Gnuplot2dDataset dataset;
+	dataset.SetStyle(Gnuplot2dDataset::LINES);
+	for (double rxPowerDbm = std::floor(mean - halfSpan); rxPowerDbm <= std::ceil(mean + halfSpan);
+		 rxPowerDbm += 1.0)
 	{
-		number = ceil(number - 0.5);
+		double probability = model->GetRxPowerCdf(txPowerDbm, distance, rxPowerDbm + 0.5) -
+							 model->GetRxPowerCdf(txPowerDbm, distance, rxPowerDbm - 0.5);
+		dataset.Add(rxPowerDbm, probability);
 	}
-	number *= precision;
-	return number;
+	return dataset;
 }
 
+/// Importance-sampled P(rx power < threshold) at each threshold, as points with 95%
+/// confidence error bars, with a table row per threshold next to the exact value and
+/// the plain Monte Carlo sample count the same relative error would take
 static Gnuplot2dDataset
-TestProbabilistic(Ptr<PropagationLossModel> model, double distance, unsigned int samples = 1000)
+TestTail(Ptr<LogNormalShadowingModel> model,
+		 const RxPowerSampler &sampler,
+		 double distance,
+		 const std::vector<double> &thresholds,
+		 double targetRelativeError,
+		 uint64_t maxSamples)
 {
-	Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
-	Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
-
-	double txPowerDbm = +15; // dBm
+	double txPowerDbm = +15; // dBm, same as TestProbabilistic
 
 	Gnuplot2dDataset dataset;
+	dataset.SetStyle(Gnuplot2dDataset::POINTS);
+	dataset.SetErrorBars(Gnuplot2dDataset::Y);
+	for (double threshold : thresholds)
+	{
+		RxPowerSampler::TailEstimate estimate =
+			sampler.EstimateTail(model->GetMeanRxPower(txPowerDbm, distance),
+								 model->GetShadowingMean(),
+								 model->GetShadowingStdDev(),
+								 threshold,
+								 targetRelativeError,
+								 maxSamples);
+		double exact = model->GetOutageProbability(txPowerDbm, distance, threshold);
+		// plain sampling has relative error sqrt((1 - p) / (n p))
+		double plainSamples = estimate.probability > 0
+								  ? (1 - estimate.probability) /
+										(estimate.probability * targetRelativeError * targetRelativeError)
+								  : std::numeric_limits<double>::infinity();
 
-	dataset.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-
-	typedef std::map<double, unsigned int> rxPowerMapType;
+		std::cout << std::setw(10) << distance << std::setw(12) << threshold << std::setw(14)
+				  << std::scientific << std::setprecision(3) << exact << std::setw(14) << estimate.probability
+				  << "  [" << estimate.lower << ", " << estimate.upper << "]" << std::setw(12)
+				  << estimate.samples << std::setw(14) << plainSamples << std::defaultfloat << "\n";
+		dataset.Add(threshold, estimate.probability, 1.96 * estimate.stdError);
+	}
+	return dataset;
+}
 
-	// Take given number of samples from CalcRxPower() and show probability
-	// density for discrete distances.
-	a->SetPosition(Vector(0.0, 0.0, 0.0));
-	b->SetPosition(Vector(distance, 0.0, 0.0));
+/// Values of a "start:stop:step" range, or of a single value
+static std::vector<double>
+ParseRange(const std::string &range, const std::string &name)
+{
+	std::vector<double> fields;
+	std::istringstream is(range);
+	std::string field;
+	while (std::getline(is, field, ':'))
+	{
+		fields.push_back(std::stod(field));
+	}
+	NS_ABORT_MSG_UNLESS(fields.size() == 1 || fields.size() == 3,
+						"--" << name << " takes start:stop:step or a single value, got " << range);
+	if (fields.size() == 1)
+	{
+		return fields;
+	}
+	NS_ABORT_MSG_UNLESS(fields[2] > 0 && fields[1] >= fields[0], "--" << name << " range " << range << " is empty");
 
-	rxPowerMapType rxPowerMap;
-	for (unsigned int samp = 0; samp < samples; ++samp)
+	std::vector<double> values;
+	// the half step keeps rounding from dropping the end point
+	for (double value = fields[0]; value <= fields[1] + fields[2] / 2; value += fields[2])
 	{
-		// CalcRxPower() returns dBm.
-		double rxPowerDbm = model->CalcRxPower(txPowerDbm, a, b);
+		values.push_back(value);
+	}
+	return values;
+}
 
-		rxPowerDbm = dround(rxPowerDbm, 1.0);
-		rxPowerMap[rxPowerDbm]++;
+/// Sampled PDF for every combination of seed, exponent, variance and distance.
+/// One plot per seed/exponent/variance with a line per distance, and every non-empty
+/// bin as a row of tableName.
+static void
+RunSweep(const RxPowerSampler &sampler,
+		 const std::vector<double> &distances,
+		 const std::vector<double> &exponents,
+		 const std::vector<double> &variances,
+		 const std::vector<double> &seeds,
+		 uint64_t samples,
+		 GnuplotCollection &gnuplots,
+		 const std::string &tableName)
+{
+	double txPowerDbm = +15; // dBm, same as TestProbabilistic
 
-		Simulator::Stop(Seconds(0.01));
-		Simulator::Run();
+	// the deterministic part stays on this thread, only the sampling is spread out
+	Ptr<LogNormalShadowingModel> model = CreateObject<LogNormalShadowingModel>();
+	std::vector<RxPowerSampler::SweepPoint> points;
+	for (double seed : seeds)
+	{
+		NS_ABORT_MSG_UNLESS(seed >= 1 && seed == std::floor(seed), "seeds must be positive integers");
+		for (double exponent : exponents)
+		{
+			model->SetPathLossExponent(exponent);
+			for (double variance : variances)
+			{
+				for (double distance : distances)
+				{
+					RxPowerSampler::SweepPoint point;
+					point.meanRxPowerDbm = model->GetMeanRxPower(txPowerDbm, distance);
+					point.shadowingMean = 0;
+					point.shadowingStdDev = std::sqrt(variance);
+					point.seed = static_cast<uint32_t>(seed);
+					points.push_back(point);
+				}
+			}
+		}
 	}
+	std::cout << "sweeping " << points.size() << " points on " << sampler.GetThreads() << " threads"
+			  << std::endl;
+
+	std::vector<RxPowerHistogram> histograms = sampler.SampleSweep(points, samples, 1.0);
 
-	for (rxPowerMapType::const_iterator i = rxPowerMap.begin(); i != rxPowerMap.end(); ++i)
+	std::ofstream table(tableName);
+	table << "seed,exponent,variance,distance,rxPowerDbm,probability\n";
+
+	std::size_t index = 0;
+	for (double seed : seeds)
 	{
-		dataset.Add(i->first, (double)i->second / (double)samples);
-	}
+		for (double exponent : exponents)
+		{
+			for (double variance : variances)
+			{
+				Gnuplot plot;
+				plot.AppendExtra("set xlabel 'rxPower (dBm)'");
+				plot.AppendExtra("set ylabel 'Probability'");
+				plot.AppendExtra("set key outside");
 
-	return dataset;
+				for (double distance : distances)
+				{
+					const RxPowerHistogram &histogram = histograms[index++];
+					for (std::size_t bin = 0; bin < histogram.GetNBins(); ++bin)
+					{
+						if (histogram.GetBinCount(bin) > 0)
+						{
+							table << seed << "," << exponent << "," << variance << "," << distance << ","
+								  << histogram.GetBinCenter(bin) << ","
+								  << static_cast<double>(histogram.GetBinCount(bin)) / histogram.GetTotal()
+								  << "\n";
+						}
+					}
+
+					std::ostringstream os;
+					os << "Distance : " << distance;
+					Gnuplot2dDataset dataset = histogram.ToDataset();
+					dataset.SetTitle(os.str());
+					plot.AddDataset(dataset);
+				}
+
+				std::ostringstream title;
+				title << "LogNormalShadowingModel n=" << exponent << " variance=" << variance
+					  << " seed=" << seed;
+				plot.SetTitle(title.str());
+				gnuplots.AddPlot(plot);
+			}
+		}
+	}
+	model->Dispose();
 }
 
 int main(int argc, char *argv[])
 {
+	uint64_t samples = 1000; // samples per distance
+	unsigned int threads = 0; // sampler worker threads, 0 uses every core
+	std::string mode = "sampled"; // sampled, analytic, both or sweep
+	// sweep ranges, start:stop:step or a single value
+	std::string distances = "200:400:50";
+	std::string exponents = "3";
+	std::string variances = "2";
+	std::string seeds = "3";
+	std::string table = "sweep.csv";
+	// tail mode
+	std::string thresholds = "-120:-90:5";
+	double targetError = 0.05;
+	uint64_t maxSamples = 10000000;
+	bool throughModel = false;
+
 	CommandLine cmd;
+	cmd.AddValue("samples", "Number of rx power samples per distance", samples);
+	cmd.AddValue("threads", "Sampler worker threads (0 for all cores)", threads);
+	cmd.AddValue("mode",
+				 "sampled: Monte Carlo PDF, analytic: exact PDF from the model, "
+				 "both: exact curve next to the sampled one for validation, "
+				 "sweep: sampled PDFs over the --distances/--exponents/--variances/--seeds grid, "
+				 "tail: importance-sampled outage probabilities at --thresholds",
+				 mode);
+	cmd.AddValue("distances", "Sweep distances (m), start:stop:step or a single value", distances);
+	cmd.AddValue("exponents", "Sweep path loss exponents, start:stop:step or a single value", exponents);
+	cmd.AddValue("variances", "Sweep shadowing variances (dB^2), start:stop:step or a single value", variances);
+	cmd.AddValue("seeds", "Sweep RNG seeds, start:stop:step or a single value", seeds);
+	cmd.AddValue("table", "CSV file the sweep writes its bins to", table);
+	cmd.AddValue("thresholds", "Tail thresholds (dBm), start:stop:step or a single value", thresholds);
+	cmd.AddValue("targetError", "Relative standard error the tail estimates stop at", targetError);
+	cmd.AddValue("maxSamples", "Sample cap per tail estimate", maxSamples);
+	cmd.AddValue("throughModel",
+				 "Draw the sampled/both PDFs through the model's CalcRxPower on one thread instead "
+				 "of the sampler, so both checks the model itself against the exact curve",
+				 throughModel);
 	cmd.Parse(argc, argv);
+	NS_ABORT_MSG_UNLESS(mode == "sampled" || mode == "analytic" || mode == "both" || mode == "sweep" ||
+							mode == "tail",
+						"unknown --mode " << mode);
 	std::ofstream plotFile("output.plt");
 
 	// Set the random seed value
@@ -111,6 +325,21 @@ int main(int argc, char *argv[])
 
 	GnuplotCollection gnuplots("hw2-task02-hp03.pdf"); // Change as needed for different parts for task02
 
+	if (mode == "sweep")
+	{
+		RxPowerSampler sampler;
+		sampler.SetThreads(threads);
+		sampler.AssignStreams(0);
+		RunSweep(sampler,
+				 ParseRange(distances, "distances"),
+				 ParseRange(exponents, "exponents"),
+				 ParseRange(variances, "variances"),
+				 ParseRange(seeds, "seeds"),
+				 samples,
+				 gnuplots,
+				 table);
+	}
+	else
 	{
 		Gnuplot plot;
 		plot.AppendExtra("set xlabel 'rxPower (dBm)'");
@@ -126,15 +355,51 @@ int main(int argc, char *argv[])
 																  // task02 hp02
 		randomProp->SetPathLossExponent(3);						  // Modify for task02 hp02
 
+		// Fixed streams keep the plot reproducible for a given --RngRun
+		int64_t streamsUsed = randomProp->AssignStreams(0);
+		RxPowerSampler sampler;
+		sampler.SetThreads(threads);
+		sampler.AssignStreams(streamsUsed);
+
+		std::vector<double> tailThresholds;
+		if (mode == "tail")
+		{
+			tailThresholds = ParseRange(thresholds, "thresholds");
+			plot.AppendExtra("set logscale y");
+			plot.AppendExtra("set format y '10^{%L}'");
+			plot.AppendExtra("set xlabel 'threshold (dBm)'");
+			plot.AppendExtra("set ylabel 'P(rxPower < threshold)'");
+			std::cout << std::setw(10) << "distance" << std::setw(12) << "threshold" << std::setw(14) << "exact"
+					  << std::setw(14) << "estimate" << "  95% CI" << std::setw(32) << "samples" << std::setw(14)
+					  << "plain MC" << "\n";
+		}
+
 		for (double distance = 200.0; distance <= 400.0;
 			 distance += 50.0) // modify upper bound between LP and HP
 		{
-			Gnuplot2dDataset dataset = TestProbabilistic(randomProp, distance);
 			// New dataset for each distance. Adds a line to the plot
 			std::ostringstream os;
 			os << "Distance : " << distance;
-			dataset.SetTitle(os.str());
-			plot.AddDataset(dataset);
+			if (mode == "tail")
+			{
+				Gnuplot2dDataset tail =
+					TestTail(randomProp, sampler, distance, tailThresholds, targetError, maxSamples);
+				tail.SetTitle(os.str());
+				plot.AddDataset(tail);
+				continue;
+			}
+			if (mode != "analytic")
+			{
+				Gnuplot2dDataset dataset = TestProbabilistic(randomProp, sampler, distance, samples, throughModel);
+				dataset.SetTitle(os.str());
+				plot.AddDataset(dataset);
+			}
+			if (mode != "sampled")
+			{
+				Gnuplot2dDataset exact = TestAnalytic(randomProp, distance);
+				exact.SetTitle(os.str() + " (exact)");
+				plot.AddDataset(exact);
+			}
 		}
 
 		plot.SetTitle("LogNormalShadowingModel");
@@ -0,0 +1,137 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#include "ns3/rx-power-histogram.h"
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+    RxPowerHistogram::RxPowerHistogram(double minDbm, double maxDbm, double resolution)
+        : m_minDbm(minDbm),
+          m_resolution(resolution),
+          m_inverseResolution(1.0 / resolution),
+          m_bins(static_cast<std::size_t>(std::max(1.0, std::ceil((maxDbm - minDbm) / resolution))), 0),
+          m_underflow(0),
+          m_overflow(0)
+    {
+        NS_ABORT_MSG_UNLESS(resolution > 0, "histogram resolution must be positive");
+        NS_ABORT_MSG_UNLESS(maxDbm > minDbm, "histogram range is empty");
+    }
+
+    RxPowerHistogram
+    RxPowerHistogram::Centered(double centerDbm, double halfSpan, double resolution)
+    {
+        double low = std::floor((centerDbm - halfSpan) / resolution) * resolution;
+        double high = std::ceil((centerDbm + halfSpan) / resolution) * resolution;
+        return RxPowerHistogram(low - 0.5 * resolution, high + 0.5 * resolution, resolution);
+    }
+
+    void
+    RxPowerHistogram::Merge(const RxPowerHistogram &other)
+    {
+        NS_ABORT_MSG_UNLESS(other.m_minDbm == m_minDbm && other.m_resolution == m_resolution &&
+                                other.m_bins.size() == m_bins.size(),
+                            "merging histograms with different layouts");
+        for (std::size_t bin = 0; bin < m_bins.size(); ++bin)
+        {
+            m_bins[bin] += other.m_bins[bin];
+        }
+        m_underflow += other.m_underflow;
+        m_overflow += other.m_overflow;
+    }
+
+    void
+    RxPowerHistogram::Reset()
+    {
+        std::fill(m_bins.begin(), m_bins.end(), 0);
+        m_underflow = 0;
+        m_overflow = 0;
+    }
+
+    std::size_t
+    RxPowerHistogram::GetNBins() const
+    {
+        return m_bins.size();
+    }
+
+    double
+    RxPowerHistogram::GetBinCenter(std::size_t bin) const
+    {
+        return m_minDbm + (bin + 0.5) * m_resolution;
+    }
+
+    uint64_t
+    RxPowerHistogram::GetBinCount(std::size_t bin) const
+    {
+        return m_bins[bin];
+    }
+
+    uint64_t
+    RxPowerHistogram::GetUnderflow() const
+    {
+        return m_underflow;
+    }
+
+    uint64_t
+    RxPowerHistogram::GetOverflow() const
+    {
+        return m_overflow;
+    }
+
+    uint64_t
+    RxPowerHistogram::GetTotal() const
+    {
+        uint64_t total = m_underflow + m_overflow;
+        for (uint64_t count : m_bins)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    double
+    RxPowerHistogram::GetMin() const
+    {
+        return m_minDbm;
+    }
+
+    double
+    RxPowerHistogram::GetMax() const
+    {
+        return m_minDbm + m_bins.size() * m_resolution;
+    }
+
+    double
+    RxPowerHistogram::GetResolution() const
+    {
+        return m_resolution;
+    }
+
+    Gnuplot2dDataset
+    RxPowerHistogram::ToDataset() const
+    {
+        Gnuplot2dDataset dataset;
+        dataset.SetStyle(Gnuplot2dDataset::LINES_POINTS);
+
+        double total = static_cast<double>(GetTotal());
+        for (std::size_t bin = 0; bin < m_bins.size(); ++bin)
+        {
+            if (m_bins[bin] > 0)
+            {
+                dataset.Add(GetBinCenter(bin), m_bins[bin] / total);
+            }
+        }
+        return dataset;
+    }
+} // namespace ns3
@@ -0,0 +1,88 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ * (ToDataset needs ${libstats} in libraries_to_link for Gnuplot2dDataset)
+ */
+
+#ifndef RX_POWER_HISTOGRAM_H
+#define RX_POWER_HISTOGRAM_H
+
+#include "ns3/gnuplot.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Fixed-bin histogram of rx power values over [min, max) dBm.
+     *
+     * Bins are preallocated in one contiguous array, so Add is an index computation
+     * and an increment with no allocation. Values outside the range go to the
+     * underflow/overflow counters. Histograms with the same layout can be merged,
+     * which is how per-thread histograms are combined.
+     */
+    class RxPowerHistogram
+    {
+    public:
+        // Bins of width resolution covering [minDbm, maxDbm), the last bin may extend past maxDbm
+        RxPowerHistogram(double minDbm, double maxDbm, double resolution);
+
+        // Histogram with resolution-wide bins centered on multiples of resolution and
+        // covering at least [centerDbm - halfSpan, centerDbm + halfSpan]
+        static RxPowerHistogram Centered(double centerDbm, double halfSpan, double resolution);
+
+        void Add(double rxPowerDbm)
+        {
+            double position = (rxPowerDbm - m_minDbm) * m_inverseResolution;
+            if (position < 0)
+            {
+                m_underflow++;
+            }
+            else if (!(position < m_bins.size())) // NaN lands here too
+            {
+                m_overflow++;
+            }
+            else
+            {
+                m_bins[static_cast<std::size_t>(position)]++;
+            }
+        }
+
+        // Adds the counts of other, which must have the same range and resolution
+        void Merge(const RxPowerHistogram &other);
+
+        // Zeroes every counter, keeping the layout
+        void Reset();
+
+        std::size_t GetNBins() const;
+        double GetBinCenter(std::size_t bin) const;
+        uint64_t GetBinCount(std::size_t bin) const;
+        uint64_t GetUnderflow() const;
+        uint64_t GetOverflow() const;
+        // Samples added so far, including underflow and overflow
+        uint64_t GetTotal() const;
+
+        double GetMin() const;
+        double GetMax() const;
+        double GetResolution() const;
+
+        // One point per non-empty bin at its center, y is the fraction of all samples
+        Gnuplot2dDataset ToDataset() const;
+
+    private:
+        double m_minDbm;               // lower edge of bin 0
+        double m_resolution;           // bin width (dB)
+        double m_inverseResolution;    // 1 / m_resolution
+        std::vector<uint64_t> m_bins;  // counts, contiguous
+        uint64_t m_underflow;          // samples below m_minDbm
+        uint64_t m_overflow;           // samples past the last bin
+    };
+} // namespace ns3
+#endif
@@ -0,0 +1,308 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#include "ns3/rx-power-sampler.h"
+#include "ns3/log.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/rng-stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("RxPowerSampler");
+
+    // Draws count samples of center + N(0, stdDev^2) from rng into histogram
+    static void
+    SampleBlock(RngStream &rng, uint64_t count, double center, double stdDev, RxPowerHistogram &histogram)
+    {
+        for (uint64_t i = 0; i < count; i += 2)
+        {
+            // Box-Muller, both outputs of a pair land in the same block
+            double radius = std::sqrt(-2.0 * std::log(rng.RandU01()));
+            double angle = 2.0 * M_PI * rng.RandU01();
+            histogram.Add(center + stdDev * radius * std::cos(angle));
+            if (i + 1 < count)
+            {
+                histogram.Add(center + stdDev * radius * std::sin(angle));
+            }
+        }
+    }
+
+    RxPowerSampler::RxPowerSampler()
+        : m_threads(0),
+          m_stream(RngSeedManager::GetNextStreamIndex())
+    {
+    }
+
+    void
+    RxPowerSampler::SetThreads(unsigned int threads)
+    {
+        m_threads = threads;
+    }
+
+    unsigned int
+    RxPowerSampler::GetThreads() const
+    {
+        if (m_threads == 0)
+        {
+            return std::max(1U, std::thread::hardware_concurrency());
+        }
+        return m_threads;
+    }
+
+    int64_t
+    RxPowerSampler::AssignStreams(int64_t stream)
+    {
+        // upper half of the stream numbers, as in RandomVariableStream::SetStream
+        m_stream = (1ULL << 63) + stream;
+        return 1;
+    }
+
+    RxPowerHistogram
+    RxPowerSampler::Sample(double meanRxPowerDbm,
+                           double shadowingMean,
+                           double shadowingStdDev,
+                           uint64_t samples,
+                           double binWidth) const
+    {
+        RxPowerHistogram histogram =
+            RxPowerHistogram::Centered(meanRxPowerDbm + shadowingMean,
+                                       std::max(8 * shadowingStdDev, binWidth),
+                                       binWidth);
+        Sample(meanRxPowerDbm, shadowingMean, shadowingStdDev, samples, histogram);
+        return histogram;
+    }
+
+    void
+    RxPowerSampler::Sample(double meanRxPowerDbm,
+                           double shadowingMean,
+                           double shadowingStdDev,
+                           uint64_t samples,
+                           RxPowerHistogram &histogram) const
+    {
+        const double center = meanRxPowerDbm + shadowingMean;
+        const uint32_t seed = RngSeedManager::GetSeed();
+        const uint64_t run = RngSeedManager::GetRun();
+        const uint64_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const unsigned int workers =
+            static_cast<unsigned int>(std::min<uint64_t>(GetThreads(), std::max<uint64_t>(blocks, 1)));
+
+        NS_LOG_DEBUG("sampling " << samples << " values in " << blocks << " blocks on " << workers
+                                 << " threads");
+
+        std::atomic<uint64_t> nextBlock(0);
+        std::vector<RxPowerHistogram> partials(
+            workers,
+            RxPowerHistogram(histogram.GetMin(), histogram.GetMax(), histogram.GetResolution()));
+
+        auto worker = [&](RxPowerHistogram &partial) {
+            for (uint64_t block = nextBlock++; block < blocks; block = nextBlock++)
+            {
+                // block b -> substream (run << 24) + b, leaving 2^24 blocks per run
+                RngStream rng(seed, m_stream, (run << 24) + block);
+                uint64_t count = std::min(BLOCK_SIZE, samples - block * BLOCK_SIZE);
+                SampleBlock(rng, count, center, shadowingStdDev, partial);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int t = 1; t < workers; ++t)
+        {
+            threads.emplace_back(worker, std::ref(partials[t]));
+        }
+        worker(partials[0]);
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const RxPowerHistogram &partial : partials)
+        {
+            histogram.Merge(partial);
+        }
+    }
+
+    std::vector<RxPowerHistogram>
+    RxPowerSampler::SampleSweep(const std::vector<SweepPoint> &points,
+                                uint64_t samples,
+                                double binWidth) const
+    {
+        std::vector<RxPowerHistogram> histograms;
+        histograms.reserve(points.size());
+        for (const SweepPoint &point : points)
+        {
+            histograms.push_back(
+                RxPowerHistogram::Centered(point.meanRxPowerDbm + point.shadowingMean,
+                                           std::max(8 * point.shadowingStdDev, binWidth),
+                                           binWidth));
+        }
+
+        const uint64_t run = RngSeedManager::GetRun();
+        const uint64_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const unsigned int workers = static_cast<unsigned int>(
+            std::min<uint64_t>(GetThreads(), std::max<std::size_t>(points.size(), 1)));
+
+        NS_LOG_DEBUG("sweeping " << points.size() << " points of " << samples << " samples on "
+                                 << workers << " threads");
+
+        // each point is owned by the worker that picked it, so no merge is needed
+        std::atomic<std::size_t> nextPoint(0);
+        auto worker = [&]() {
+            for (std::size_t p = nextPoint++; p < points.size(); p = nextPoint++)
+            {
+                const SweepPoint &point = points[p];
+                for (uint64_t block = 0; block < blocks; ++block)
+                {
+                    // same substreams as Sample, so both give the same histogram
+                    RngStream rng(point.seed, m_stream, (run << 24) + block);
+                    uint64_t count = std::min(BLOCK_SIZE, samples - block * BLOCK_SIZE);
+                    SampleBlock(rng,
+                                count,
+                                point.meanRxPowerDbm + point.shadowingMean,
+                                point.shadowingStdDev,
+                                histograms[p]);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int t = 1; t < workers; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        return histograms;
+    }
+
+    RxPowerSampler::TailEstimate
+    RxPowerSampler::EstimateTail(double meanRxPowerDbm,
+                                 double shadowingMean,
+                                 double shadowingStdDev,
+                                 double thresholdDbm,
+                                 double targetRelativeError,
+                                 uint64_t maxSamples) const
+    {
+        const double center = meanRxPowerDbm + shadowingMean;
+        TailEstimate estimate;
+        if (shadowingStdDev == 0)
+        {
+            estimate.probability = center < thresholdDbm ? 1.0 : 0.0;
+            estimate.stdError = 0;
+            estimate.lower = estimate.upper = estimate.probability;
+            estimate.samples = 0;
+            return estimate;
+        }
+
+        /**
+         * Draws come from N(proposal, sigma^2) with the proposal on the threshold (or left
+         * on the mean if the threshold is above it, where the tail is not rare). With
+         * y = proposal + sigma * z and shift = (proposal - center) / sigma the likelihood
+         * ratio N(y; center) / N(y; proposal) is exp(-shift * z - shift^2 / 2).
+         */
+        const double proposal = std::min(thresholdDbm, center);
+        const double shift = (proposal - center) / shadowingStdDev;
+        const uint32_t seed = RngSeedManager::GetSeed();
+        const uint64_t run = RngSeedManager::GetRun();
+        const uint64_t maxBlocks = std::max<uint64_t>((maxSamples + TAIL_BLOCK_SIZE - 1) / TAIL_BLOCK_SIZE, 1);
+        const unsigned int workers = static_cast<unsigned int>(std::min<uint64_t>(GetThreads(), maxBlocks));
+
+        // weighted hit sums of each block, sum of w and sum of w^2
+        struct BlockSums
+        {
+            double sum;
+            double sumSq;
+        };
+
+        double sum = 0;
+        double sumSq = 0;
+        uint64_t n = 0;
+        uint64_t doneBlocks = 0;
+        bool converged = false;
+        while (!converged && doneBlocks < maxBlocks)
+        {
+            // one wave of blocks, then fold them in block order so the stopping point is
+            // the same whatever the number of workers
+            const uint64_t waveBlocks = std::min<uint64_t>(workers, maxBlocks - doneBlocks);
+            std::vector<BlockSums> sums(waveBlocks);
+            std::atomic<uint64_t> nextBlock(0);
+            auto worker = [&]() {
+                for (uint64_t i = nextBlock++; i < waveBlocks; i = nextBlock++)
+                {
+                    // substreams from 2^23 on, clear of the ones Sample uses for up to
+                    // 2^39 samples
+                    RngStream rng(seed, m_stream, (run << 24) + (1 << 23) + doneBlocks + i);
+                    BlockSums &block = sums[i];
+                    block.sum = 0;
+                    block.sumSq = 0;
+                    for (uint64_t j = 0; j < TAIL_BLOCK_SIZE; j += 2)
+                    {
+                        double radius = std::sqrt(-2.0 * std::log(rng.RandU01()));
+                        double angle = 2.0 * M_PI * rng.RandU01();
+                        for (double z : {radius * std::cos(angle), radius * std::sin(angle)})
+                        {
+                            if (proposal + shadowingStdDev * z < thresholdDbm)
+                            {
+                                double weight = std::exp(-shift * z - 0.5 * shift * shift);
+                                block.sum += weight;
+                                block.sumSq += weight * weight;
+                            }
+                        }
+                    }
+                }
+            };
+            std::vector<std::thread> threads;
+            for (unsigned int t = 1; t < workers; ++t)
+            {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+
+            for (const BlockSums &block : sums)
+            {
+                sum += block.sum;
+                sumSq += block.sumSq;
+                n += TAIL_BLOCK_SIZE;
+                doneBlocks++;
+                double mean = sum / n;
+                double variance = std::max(sumSq / n - mean * mean, 0.0) * n / (n - 1);
+                if (mean > 0 && std::sqrt(variance / n) <= targetRelativeError * mean)
+                {
+                    converged = true;
+                    break;
+                }
+            }
+        }
+
+        estimate.probability = sum / n;
+        double variance = std::max(sumSq / n - estimate.probability * estimate.probability, 0.0) * n / (n - 1);
+        estimate.stdError = std::sqrt(variance / n);
+        estimate.lower = std::max(estimate.probability - 1.96 * estimate.stdError, 0.0);
+        estimate.upper = std::min(estimate.probability + 1.96 * estimate.stdError, 1.0);
+        estimate.samples = n;
+
+        NS_LOG_DEBUG("tail below " << thresholdDbm << "dBm: " << estimate.probability << " +- "
+                                   << estimate.stdError << " from " << n << " samples"
+                                   << (converged ? "" : ", target not reached"));
+        return estimate;
+    }
+} // namespace ns3
@@ -0,0 +1,111 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#ifndef RX_POWER_SAMPLER_H
+#define RX_POWER_SAMPLER_H
+
+#include "ns3/rx-power-histogram.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Multi-threaded Monte Carlo sampler for rx power = mean + N(shadowingMean, stdDev^2).
+     *
+     * Samples are split into fixed-size blocks and block b always draws from its own
+     * MRG32k3a substream of the sampler's stream, so the merged result for a given
+     * seed/run/stream does not depend on the number of worker threads.
+     * Workers fill thread-local histograms that are merged once all blocks are done.
+     *
+     * Only plain RngStream objects are touched from the workers, the Simulator and
+     * the propagation model stay on the calling thread.
+     */
+    class RxPowerSampler
+    {
+    public:
+        // Takes a fresh stream from RngSeedManager, like an unassigned RandomVariableStream
+        RxPowerSampler();
+
+        // Number of worker threads, 0 uses every hardware thread
+        void SetThreads(unsigned int threads);
+        unsigned int GetThreads() const;
+
+        // Fixes the RNG stream used by the sampler, returns the number of streams used (1)
+        int64_t AssignStreams(int64_t stream);
+
+        // Draws samples into a histogram with the given bin width, covering +-8 stdDev
+        // around the mean
+        RxPowerHistogram Sample(double meanRxPowerDbm,
+                                double shadowingMean,
+                                double shadowingStdDev,
+                                uint64_t samples,
+                                double binWidth) const;
+
+        // Same, but fills the given histogram (its counters are added to, not reset)
+        void Sample(double meanRxPowerDbm,
+                    double shadowingMean,
+                    double shadowingStdDev,
+                    uint64_t samples,
+                    RxPowerHistogram &histogram) const;
+
+        // One point of a parameter sweep
+        struct SweepPoint
+        {
+            double meanRxPowerDbm;
+            double shadowingMean;
+            double shadowingStdDev;
+            uint32_t seed; // RngSeedManager seed the point is drawn under
+        };
+
+        // Samples every point, handing whole points to the worker threads, which suits
+        // many points of few samples better than Sample's split of one point into blocks.
+        // Histogram i matches what Sample returns for points[i] under seed points[i].seed.
+        std::vector<RxPowerHistogram> SampleSweep(const std::vector<SweepPoint> &points,
+                                                  uint64_t samples,
+                                                  double binWidth) const;
+
+        // Estimate of a lower-tail probability with its 95% confidence interval
+        struct TailEstimate
+        {
+            double probability;
+            double stdError;
+            double lower;      // 95% confidence interval
+            double upper;
+            uint64_t samples;  // draws used
+        };
+
+        // Importance-sampling estimate of P(rx power < thresholdDbm). The shadowing
+        // Gaussian is shifted (exponentially tilted) so its mean sits on the threshold and
+        // each draw is reweighted by the likelihood ratio. Blocks of TAIL_BLOCK_SIZE
+        // draws are added in order until the relative standard error is at most
+        // targetRelativeError or maxSamples is reached; the stopping point, and so the
+        // result, does not depend on the thread count.
+        TailEstimate EstimateTail(double meanRxPowerDbm,
+                                  double shadowingMean,
+                                  double shadowingStdDev,
+                                  double thresholdDbm,
+                                  double targetRelativeError,
+                                  uint64_t maxSamples) const;
+
+        // Samples per RNG substream in EstimateTail
+        static constexpr uint64_t TAIL_BLOCK_SIZE = 1 << 10;
+
+        // Samples per RNG substream, fixed so results don't depend on the thread count
+        static constexpr uint64_t BLOCK_SIZE = 1 << 16;
+
+    private:
+        unsigned int m_threads; // worker threads, 0 for hardware concurrency
+        uint64_t m_stream;      // MRG32k3a stream shared by all blocks
+    };
+} // namespace ns3
+#endif
@@ -0,0 +1,200 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#include "ns3/uniform-grid-index.h"
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("UniformGridIndex");
+
+    UniformGridIndex::UniformGridIndex(double cellSize)
+        : m_cellSize(cellSize),
+          m_refreshedAt(Seconds(-1)) // before any simulation time
+    {
+        NS_ABORT_MSG_UNLESS(cellSize > 0, "grid cell size must be positive");
+    }
+
+    UniformGridIndex::~UniformGridIndex()
+    {
+        for (Entry &entry : m_entries)
+        {
+            entry.mobility->TraceDisconnectWithoutContext(
+                "CourseChange",
+                MakeCallback(&UniformGridIndex::NotifyCourseChange, this));
+        }
+    }
+
+    int64_t
+    UniformGridIndex::PackCell(int64_t cellX, int64_t cellY)
+    {
+        // 32 bits per axis is plenty for any cell size above a millimetre
+        return static_cast<int64_t>((static_cast<uint64_t>(cellX) << 32) ^
+                                    static_cast<uint32_t>(cellY));
+    }
+
+    int64_t
+    UniformGridIndex::CellOf(const Vector &position) const
+    {
+        return PackCell(static_cast<int64_t>(std::floor(position.x / m_cellSize)),
+                        static_cast<int64_t>(std::floor(position.y / m_cellSize)));
+    }
+
+    void
+    UniformGridIndex::Add(Ptr<MobilityModel> mobility)
+    {
+        if (m_entryOf.count(PeekPointer(mobility)))
+        {
+            return;
+        }
+        Entry entry;
+        entry.mobility = mobility;
+        entry.position = mobility->GetPosition();
+        entry.cell = CellOf(entry.position);
+
+        uint32_t index = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(entry);
+        m_cells[entry.cell].push_back(index);
+        m_entryOf[PeekPointer(mobility)] = index;
+        if (!DynamicCast<ConstantPositionMobilityModel>(mobility))
+        {
+            m_mobile.push_back(index);
+        }
+
+        mobility->TraceConnectWithoutContext("CourseChange",
+                                             MakeCallback(&UniformGridIndex::NotifyCourseChange, this));
+    }
+
+    void
+    UniformGridIndex::NotifyCourseChange(Ptr<const MobilityModel> mobility)
+    {
+        auto found = m_entryOf.find(PeekPointer(mobility));
+        if (found != m_entryOf.end())
+        {
+            Update(found->second);
+        }
+    }
+
+    void
+    UniformGridIndex::Update(uint32_t index)
+    {
+        Entry &entry = m_entries[index];
+        entry.position = entry.mobility->GetPosition();
+        int64_t cell = CellOf(entry.position);
+        if (cell == entry.cell)
+        {
+            return;
+        }
+
+        std::vector<uint32_t> &oldCell = m_cells[entry.cell];
+        oldCell.erase(std::find(oldCell.begin(), oldCell.end(), index));
+        if (oldCell.empty())
+        {
+            m_cells.erase(entry.cell);
+        }
+        m_cells[cell].push_back(index);
+        entry.cell = cell;
+    }
+
+    void
+    UniformGridIndex::RefreshMobile()
+    {
+        Time now = Simulator::Now();
+        if (now == m_refreshedAt)
+        {
+            return;
+        }
+        m_refreshedAt = now;
+        for (uint32_t index : m_mobile)
+        {
+            Update(index);
+        }
+        NS_LOG_LOGIC("refreshed " << m_mobile.size() << " moving entries at " << now);
+    }
+
+    void
+    UniformGridIndex::GetWithinRange(const Vector &position,
+                                     double range,
+                                     std::vector<Ptr<MobilityModel>> &candidates)
+    {
+        RefreshMobile();
+
+        int64_t minX = static_cast<int64_t>(std::floor((position.x - range) / m_cellSize));
+        int64_t maxX = static_cast<int64_t>(std::floor((position.x + range) / m_cellSize));
+        int64_t minY = static_cast<int64_t>(std::floor((position.y - range) / m_cellSize));
+        int64_t maxY = static_cast<int64_t>(std::floor((position.y + range) / m_cellSize));
+
+        std::vector<uint32_t> hits;
+        const double rangeSq = range * range;
+        auto test = [&](uint32_t index) {
+            const Vector &other = m_entries[index].position;
+            double dx = other.x - position.x;
+            double dy = other.y - position.y;
+            double dz = other.z - position.z;
+            if (dx * dx + dy * dy + dz * dz <= rangeSq)
+            {
+                hits.push_back(index);
+            }
+        };
+
+        // a range much larger than the cells would visit mostly empty cells
+        double cellsToVisit = static_cast<double>(maxX - minX + 1) * (maxY - minY + 1);
+        if (cellsToVisit > m_entries.size())
+        {
+            for (uint32_t index = 0; index < m_entries.size(); ++index)
+            {
+                test(index);
+            }
+            minX = maxX + 1; // skip the cell walk
+        }
+
+        for (int64_t cellX = minX; cellX <= maxX; ++cellX)
+        {
+            for (int64_t cellY = minY; cellY <= maxY; ++cellY)
+            {
+                auto cell = m_cells.find(PackCell(cellX, cellY));
+                if (cell == m_cells.end())
+                {
+                    continue;
+                }
+                for (uint32_t index : cell->second)
+                {
+                    test(index);
+                }
+            }
+        }
+
+        std::sort(hits.begin(), hits.end());
+        NS_LOG_LOGIC(hits.size() << " of " << m_entries.size() << " within " << range << "m");
+        for (uint32_t index : hits)
+        {
+            candidates.push_back(m_entries[index].mobility);
+        }
+    }
+
+    std::size_t
+    UniformGridIndex::GetSize() const
+    {
+        return m_entries.size();
+    }
+
+    double
+    UniformGridIndex::GetCellSize() const
+    {
+        return m_cellSize;
+    }
+} // namespace ns3
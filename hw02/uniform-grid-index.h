@@ -0,0 +1,86 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#ifndef UNIFORM_GRID_INDEX_H
+#define UNIFORM_GRID_INDEX_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Uniform-grid spatial index over mobility models, bucketed on x/y.
+     *
+     * Receivers are hashed into square cells of a fixed size, and a range query only
+     * visits the cells overlapping the query square before the exact distance test.
+     * ConstantPositionMobilityModel receivers are kept up to date through CourseChange.
+     * Any other model may move without reporting it (ConstantVelocity, RandomWalk2d
+     * between course changes), so the first query at each simulation time re-reads
+     * their positions and moves them to their current cell; queries always test
+     * positions as of Simulator::Now.
+     *
+     * Query results are in insertion order, so a channel iterating them schedules
+     * receptions in the same order as iterating all of its PHYs.
+     */
+    class UniformGridIndex
+    {
+    public:
+        explicit UniformGridIndex(double cellSize);
+        ~UniformGridIndex();
+
+        UniformGridIndex(const UniformGridIndex &) = delete;
+        UniformGridIndex &operator=(const UniformGridIndex &) = delete;
+
+        void Add(Ptr<MobilityModel> mobility);
+
+        // Appends to candidates every indexed model within range (m) of position
+        void GetWithinRange(const Vector &position,
+                            double range,
+                            std::vector<Ptr<MobilityModel>> &candidates);
+
+        std::size_t GetSize() const;
+        double GetCellSize() const;
+
+    private:
+        struct Entry
+        {
+            Ptr<MobilityModel> mobility;
+            Vector position; // as of the last course change or refresh
+            int64_t cell;    // packed cell coordinates
+        };
+
+        int64_t CellOf(const Vector &position) const;
+        static int64_t PackCell(int64_t cellX, int64_t cellY);
+
+        // CourseChange sink, moves the entry to its new cell
+        void NotifyCourseChange(Ptr<const MobilityModel> mobility);
+
+        // Re-reads the position of entry index and moves it to its new cell
+        void Update(uint32_t index);
+
+        // Updates every entry in m_mobile, once per simulation time
+        void RefreshMobile();
+
+        double m_cellSize;
+        std::vector<Entry> m_entries;                                    // insertion order
+        std::unordered_map<int64_t, std::vector<uint32_t>> m_cells;     // cell -> entry indices
+        std::unordered_map<const MobilityModel *, uint32_t> m_entryOf;  // model -> entry index
+        std::vector<uint32_t> m_mobile; // entries that are not ConstantPositionMobilityModel
+        Time m_refreshedAt;             // simulation time m_mobile was last refreshed at
+    };
+} // namespace ns3
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
+ *
+ * Receiver culling: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3, replacing the stock file
+ * ns-allinone-3.39/ns-3.39/src/wifi/model/yans-wifi-channel.h
+ * together with yans-wifi-channel.cc. YansWifiPhy holds a Ptr<YansWifiChannel> and
+ * Send is not virtual, so a subclass could not take over the per-PHY loop.
+ */
+
+#ifndef YANS_WIFI_CHANNEL_H
+#define YANS_WIFI_CHANNEL_H
+
+#include "ns3/channel.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class NetDevice;
+class PropagationLossModel;
+class PropagationDelayModel;
+class LogNormalShadowingModel;
+class MobilityModel;
+class YansWifiPhy;
+class WifiPpdu;
+
+/**
+ * \brief a channel to interconnect ns3::YansWifiPhy objects.
+ * \ingroup wifi
+ *
+ * This class is expected to be used in tandem with the ns3::YansWifiPhy
+ * class and supports an ns3::PropagationLossModel and an
+ * ns3::PropagationDelayModel.  By default, no propagation models are set;
+ * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the loss model is a LogNormalShadowingModel with its Culling attribute set and
+ * no model chained after it, Send only visits the PHYs whose mobility model
+ * GetCullingCandidates returns, instead of scheduling a reception at every PHY just for
+ * it to be dropped below the sensitivity. The PHYs are registered with the model as
+ * culling receivers on the first Send after they were added. Receptions are scheduled
+ * in the same order as without culling, unless a node has several PHYs on the channel
+ * interleaved with other nodes' PHYs or the script registered receivers itself.
+ */
+class YansWifiChannel : public Channel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    YansWifiChannel();
+    ~YansWifiChannel() override;
+
+    std::size_t GetNDevices() const override;
+    Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+    /**
+     * Adds the given YansWifiPhy to the PHY list
+     *
+     * \param phy the YansWifiPhy to be added to the PHY list
+     */
+    void Add(Ptr<YansWifiPhy> phy);
+
+    /**
+     * \param loss the new propagation loss model.
+     */
+    void SetPropagationLossModel(const Ptr<PropagationLossModel> loss);
+    /**
+     * \param delay the new propagation delay model.
+     */
+    void SetPropagationDelayModel(const Ptr<PropagationDelayModel> delay);
+
+    /**
+     * \param sender the PHY object from which the packet is originating.
+     * \param ppdu the PPDU to send
+     * \param txPowerDbm the TX power associated to the packet, in dBm
+     *
+     * This method should not be invoked by normal users. It is
+     * currently invoked only from YansWifiPhy::StartTx.  The channel
+     * attempts to deliver the PPDU to all other YansWifiPhy objects
+     * on the channel (except for the sender), or with culling to the
+     * candidates of the loss model.
+     */
+    void Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     *
+     * \param stream first stream index to use
+     *
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    /**
+     * A vector of pointers to YansWifiPhy.
+     */
+    typedef std::vector<Ptr<YansWifiPhy>> PhyList;
+
+    /**
+     * This method is scheduled by Send for each associated YansWifiPhy.
+     * The method then calls the corresponding YansWifiPhy that the first
+     * bit of the packet has arrived.
+     *
+     * \param receiver the device to which the packet is destined
+     * \param ppdu the PPDU being sent
+     * \param txPowerDbm the TX power associated to the packet being sent (dBm)
+     */
+    static void Receive(Ptr<YansWifiPhy> receiver, Ptr<const WifiPpdu> ppdu, double txPowerDbm);
+
+    /**
+     * Schedules the reception of the PPDU at one PHY, unless it is the sender or on
+     * another channel width
+     *
+     * \param sender the PHY object from which the packet is originating
+     * \param senderMobility the mobility model of the sender
+     * \param receiver the PHY to deliver to
+     * \param ppdu the PPDU to send
+     * \param txPowerDbm the TX power associated to the packet, in dBm
+     */
+    void SendTo(Ptr<YansWifiPhy> sender,
+                Ptr<MobilityModel> senderMobility,
+                Ptr<YansWifiPhy> receiver,
+                Ptr<const WifiPpdu> ppdu,
+                double txPowerDbm) const;
+
+    /**
+     * \return the loss model if Send can restrict itself to its culling candidates,
+     *         with every PHY registered as a culling receiver, else null
+     */
+    Ptr<LogNormalShadowingModel> GetCullingModel() const;
+
+    PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
+    Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
+    Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+    mutable Ptr<PropagationLossModel> m_cullingLoss;      //!< m_loss the culling state is for
+    mutable Ptr<LogNormalShadowingModel> m_cullingModel;  //!< m_cullingLoss if it can cull
+    mutable std::size_t m_registered;                     //!< PHYs registered as receivers
+    mutable std::unordered_map<const MobilityModel *, PhyList> m_physOf; //!< PHYs per mobility
+    mutable std::vector<Ptr<MobilityModel>> m_candidates; //!< Send scratch
+};
+
+} // namespace ns3
+
+#endif /* YANS_WIFI_CHANNEL_H */
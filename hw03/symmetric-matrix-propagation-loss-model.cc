@@ -0,0 +1,160 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#include "ns3/symmetric-matrix-propagation-loss-model.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("SymmetricMatrixPropagationLossModel");
+
+    NS_OBJECT_ENSURE_REGISTERED(SymmetricMatrixPropagationLossModel);
+
+    TypeId
+    SymmetricMatrixPropagationLossModel::GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::SymmetricMatrixPropagationLossModel")
+                .SetParent<PropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<SymmetricMatrixPropagationLossModel>()
+                .AddAttribute("DefaultLoss",
+                              "The default value for propagation loss, dB.",
+                              DoubleValue(std::numeric_limits<double>::max()),
+                              MakeDoubleAccessor(&SymmetricMatrixPropagationLossModel::SetDefaultLoss,
+                                                 &SymmetricMatrixPropagationLossModel::GetDefaultLoss),
+                              MakeDoubleChecker<double>());
+        return tid;
+    }
+
+    SymmetricMatrixPropagationLossModel::SymmetricMatrixPropagationLossModel()
+        : m_nodes(0),
+          m_defaultLoss(std::numeric_limits<double>::max())
+    {
+    }
+
+    std::size_t
+    SymmetricMatrixPropagationLossModel::Index(uint32_t i, uint32_t j)
+    {
+        if (i > j)
+        {
+            std::swap(i, j);
+        }
+        return static_cast<std::size_t>(j) * (j - 1) / 2 + i;
+    }
+
+    uint32_t
+    SymmetricMatrixPropagationLossModel::NodeIndex(Ptr<MobilityModel> mobility) const
+    {
+        auto cached = m_nodeIds.find(PeekPointer(mobility));
+        if (cached != m_nodeIds.end())
+        {
+            return cached->second.id;
+        }
+        Ptr<Node> node = mobility->GetObject<Node>();
+        if (!node)
+        {
+            // not cached, the model may still be aggregated to a Node later
+            return NO_NODE;
+        }
+        m_nodeIds[PeekPointer(mobility)] = NodeId{mobility, node->GetId()};
+        return node->GetId();
+    }
+
+    void
+    SymmetricMatrixPropagationLossModel::SetNodeCount(uint32_t nodes)
+    {
+        if (nodes > m_nodes)
+        {
+            m_loss.resize(static_cast<std::size_t>(nodes) * (nodes - 1) / 2,
+                          std::numeric_limits<double>::quiet_NaN());
+            m_nodes = nodes;
+        }
+    }
+
+    uint32_t
+    SymmetricMatrixPropagationLossModel::GetNodeCount() const
+    {
+        return m_nodes;
+    }
+
+    void
+    SymmetricMatrixPropagationLossModel::SetLoss(uint32_t a, uint32_t b, double loss)
+    {
+        NS_LOG_FUNCTION(this << a << b << loss);
+        NS_ABORT_MSG_IF(a == b, "No loss between node " << a << " and itself");
+        SetNodeCount(std::max(a, b) + 1);
+        m_loss[Index(a, b)] = loss;
+    }
+
+    void
+    SymmetricMatrixPropagationLossModel::SetLoss(Ptr<MobilityModel> a,
+                                                 Ptr<MobilityModel> b,
+                                                 double loss)
+    {
+        uint32_t i = NodeIndex(a);
+        uint32_t j = NodeIndex(b);
+        NS_ABORT_MSG_IF(i == NO_NODE || j == NO_NODE,
+                        "SymmetricMatrixPropagationLossModel needs mobility models aggregated to a Node");
+        SetLoss(i, j, loss);
+    }
+
+    double
+    SymmetricMatrixPropagationLossModel::GetLoss(uint32_t a, uint32_t b) const
+    {
+        if (a == b || a >= m_nodes || b >= m_nodes)
+        {
+            return m_defaultLoss;
+        }
+        double loss = m_loss[Index(a, b)];
+        return std::isnan(loss) ? m_defaultLoss : loss;
+    }
+
+    void
+    SymmetricMatrixPropagationLossModel::SetDefaultLoss(double defaultLoss)
+    {
+        m_defaultLoss = defaultLoss;
+    }
+
+    double
+    SymmetricMatrixPropagationLossModel::GetDefaultLoss() const
+    {
+        return m_defaultLoss;
+    }
+
+    double
+    SymmetricMatrixPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                                       Ptr<MobilityModel> a,
+                                                       Ptr<MobilityModel> b) const
+    {
+        // NO_NODE is never below m_nodes, so GetLoss falls back to the default for it
+        return txPowerDbm - GetLoss(NodeIndex(a), NodeIndex(b));
+    }
+
+    int64_t
+    SymmetricMatrixPropagationLossModel::DoAssignStreams(int64_t stream)
+    {
+        return 0;
+    }
+
+    void
+    SymmetricMatrixPropagationLossModel::DoDispose()
+    {
+        // the cached models reach back to this model through their Node and its channel
+        m_nodeIds.clear();
+        PropagationLossModel::DoDispose();
+    }
+}
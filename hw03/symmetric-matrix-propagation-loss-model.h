@@ -0,0 +1,91 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/propagation/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/propagation/CMakeLists.txt
+ */
+
+#ifndef SYMMETRIC_MATRIX_PROPAGATION_LOSS_MODEL_H
+#define SYMMETRIC_MATRIX_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/object.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Fixed loss per pair of nodes, like MatrixPropagationLossModel, but always symmetric
+     * and indexed by Node id instead of a std::map keyed by mobility model pointers.
+     *
+     * The strict upper triangle is stored packed and column by column in one vector:
+     * loss(i, j), i < j, sits at j * (j - 1) / 2 + i. Adding nodes only appends columns,
+     * so existing entries never move. 200 nodes take 19900 entries (155 KiB).
+     *
+     * The node id of each mobility model is resolved once through its aggregated Node
+     * and cached, so a lookup is two hash-map reads and an array read.
+     *
+     * Pairs never set use DefaultLoss, as do mobility models without an aggregated Node.
+     */
+    class SymmetricMatrixPropagationLossModel : public PropagationLossModel
+    {
+    public:
+        static TypeId GetTypeId(); // Returns object TypeId
+        SymmetricMatrixPropagationLossModel();
+
+        SymmetricMatrixPropagationLossModel(const SymmetricMatrixPropagationLossModel &) = delete;
+        SymmetricMatrixPropagationLossModel &operator=(const SymmetricMatrixPropagationLossModel &) =
+            delete;
+
+        // Sizes the matrix for node ids 0..nodes-1 up front, SetLoss also grows it on demand
+        void SetNodeCount(uint32_t nodes);
+        uint32_t GetNodeCount() const;
+
+        // Loss (dB, positive) between nodes a and b, in both directions
+        void SetLoss(uint32_t a, uint32_t b, double loss);
+        // Same, for the Nodes the two mobility models are aggregated to
+        void SetLoss(Ptr<MobilityModel> a, Ptr<MobilityModel> b, double loss);
+        // Loss between nodes a and b, DefaultLoss if the pair was never set
+        double GetLoss(uint32_t a, uint32_t b) const;
+
+        // Loss of every pair not set with SetLoss, also after the fact
+        void SetDefaultLoss(double defaultLoss);
+        double GetDefaultLoss() const;
+
+    private:
+        double DoCalcRxPower(double txPowerDbm,
+                             Ptr<MobilityModel> a,
+                             Ptr<MobilityModel> b) const override;
+        int64_t DoAssignStreams(int64_t stream) override;
+        void DoDispose() override;
+
+        // Position of pair (i, j), i != j, in m_loss
+        static std::size_t Index(uint32_t i, uint32_t j);
+        // Node id of the mobility model, or NO_NODE without an aggregated Node
+        uint32_t NodeIndex(Ptr<MobilityModel> mobility) const;
+
+        static constexpr uint32_t NO_NODE = 0xffffffff;
+
+        // Cached node id, holding the model so its address is not reused while cached
+        struct NodeId
+        {
+            Ptr<MobilityModel> mobility;
+            uint32_t id;
+        };
+
+        std::vector<double> m_loss; // packed upper triangle, NaN where DefaultLoss applies
+        uint32_t m_nodes;           // node ids covered by m_loss
+        double m_defaultLoss;       // loss of unset pairs (dB)
+        mutable std::unordered_map<const MobilityModel *, NodeId> m_nodeIds; // model -> node id
+    };
+} // namespace ns3
+#endif
@@ -0,0 +1,416 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/wifi/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/wifi/CMakeLists.txt
+ */
+
+#include "ns3/table-error-rate-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/yans-error-rate-model.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("TableErrorRateModel");
+
+    NS_OBJECT_ENSURE_REGISTERED(TableErrorRateModel);
+
+    namespace
+    {
+        // Exclusive flock on a file for the lifetime of the object, released on close
+        class FileLock
+        {
+        public:
+            explicit FileLock(const std::string &path)
+                : m_fd(open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644))
+            {
+                if (m_fd < 0)
+                {
+                    NS_LOG_WARN("Could not open " << path << ", saving without a lock");
+                    return;
+                }
+                while (flock(m_fd, LOCK_EX) != 0 && errno == EINTR)
+                {
+                }
+            }
+
+            ~FileLock()
+            {
+                if (m_fd >= 0)
+                {
+                    close(m_fd);
+                }
+            }
+
+            FileLock(const FileLock &) = delete;
+            FileLock &operator=(const FileLock &) = delete;
+
+        private:
+            int m_fd;
+        };
+    } // namespace
+
+    TypeId
+    TableErrorRateModel::GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::TableErrorRateModel")
+                .SetParent<ErrorRateModel>()
+                .SetGroupName("Wifi")
+                .AddConstructor<TableErrorRateModel>()
+                .AddAttribute("ErrorRateModel",
+                              "The error rate model the tables are built from, "
+                              "NistErrorRateModel or YansErrorRateModel",
+                              StringValue("ns3::NistErrorRateModel"),
+                              MakePointerAccessor(&TableErrorRateModel::SetErrorRateModel,
+                                                  &TableErrorRateModel::GetErrorRateModel),
+                              MakePointerChecker<ErrorRateModel>())
+                .AddAttribute("MinSnr",
+                              "Lowest SNR of the tables (dB), lower SNRs use its value",
+                              DoubleValue(-10.0),
+                              MakeDoubleAccessor(&TableErrorRateModel::m_minSnrDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("MaxSnr",
+                              "Highest SNR of the tables (dB), higher SNRs use its value",
+                              DoubleValue(40.0),
+                              MakeDoubleAccessor(&TableErrorRateModel::m_maxSnrDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("Step",
+                              "SNR spacing of the tables (dB)",
+                              DoubleValue(0.05),
+                              MakeDoubleAccessor(&TableErrorRateModel::m_stepDb),
+                              MakeDoubleChecker<double>(1e-3))
+                .AddAttribute("ReferenceBits",
+                              "Chunk size (bits) the table error is checked at, by default the "
+                              "1464 byte MPDU of a 1400 byte UDP payload",
+                              UintegerValue(11712),
+                              MakeUintegerAccessor(&TableErrorRateModel::m_referenceBits),
+                              MakeUintegerChecker<uint64_t>(1))
+                .AddAttribute("Tolerance",
+                              "Success rate error of a ReferenceBits or a 24-bit chunk above "
+                              "which building a table logs a warning",
+                              DoubleValue(0.005),
+                              MakeDoubleAccessor(&TableErrorRateModel::m_tolerance),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("CacheFile",
+                              "File the tables are loaded from and saved to, empty to always "
+                              "build them",
+                              StringValue(""),
+                              MakeStringAccessor(&TableErrorRateModel::m_cacheFile),
+                              MakeStringChecker());
+        return tid;
+    }
+
+    TableErrorRateModel::TableErrorRateModel()
+        : m_model(CreateObject<NistErrorRateModel>()),
+          m_minSnrDb(-10.0),
+          m_maxSnrDb(40.0),
+          m_stepDb(0.05),
+          m_referenceBits(11712),
+          m_tolerance(0.005),
+          m_tables(nullptr),
+          m_maxTableError(0)
+    {
+    }
+
+    void
+    TableErrorRateModel::DoDispose()
+    {
+        m_tables = nullptr;
+        m_model = nullptr;
+        ErrorRateModel::DoDispose();
+    }
+
+    void
+    TableErrorRateModel::SetErrorRateModel(Ptr<ErrorRateModel> model)
+    {
+        // the per-bit tables assume csr = (1 - pe)^nbits, which other models don't follow
+        NS_ABORT_MSG_UNLESS(DynamicCast<NistErrorRateModel>(model) ||
+                                DynamicCast<YansErrorRateModel>(model),
+                            "TableErrorRateModel can only wrap NistErrorRateModel or "
+                            "YansErrorRateModel, not "
+                                << (model ? model->GetInstanceTypeId().GetName() : "null"));
+        m_model = model;
+        m_tables = nullptr;
+    }
+
+    Ptr<ErrorRateModel>
+    TableErrorRateModel::GetErrorRateModel() const
+    {
+        return m_model;
+    }
+
+    double
+    TableErrorRateModel::GetMaxTableError() const
+    {
+        return m_maxTableError;
+    }
+
+    std::size_t
+    TableErrorRateModel::GetTableCount() const
+    {
+        return m_tables ? m_tables->size() : 0;
+    }
+
+    std::map<TableErrorRateModel::TableKey, TableErrorRateModel::Table> &
+    TableErrorRateModel::SharedTables(const std::string &signature)
+    {
+        static std::map<std::string, std::map<TableKey, Table>> tables;
+        return tables[signature];
+    }
+
+    // Floor of the per-bit log success rate, keeps exp() and the interpolation finite
+    static const double MIN_LOG_SUCCESS = -700.0;
+    // Short chunk the tables are checked at besides ReferenceBits, an L-SIG header
+    static const uint64_t SHORT_CHUNK_BITS = 24;
+    // Bumped when the meaning of the table values changes, so stale cache lines are ignored
+    static const int TABLE_FORMAT = 2;
+
+    const TableErrorRateModel::Table &
+    TableErrorRateModel::GetTable(WifiMode mode,
+                                  const WifiTxVector &txVector,
+                                  WifiPpduField field,
+                                  uint16_t staId) const
+    {
+        if (!m_tables)
+        {
+            // attributes are final by the first reception
+            m_signature = CacheSignature();
+            m_tables = &SharedTables(m_signature);
+            LoadCache(m_signature);
+        }
+        TableKey key(mode.GetUniqueName(), static_cast<int>(field));
+        auto found = m_tables->find(key);
+        if (found != m_tables->end())
+        {
+            return found->second;
+        }
+
+        // success rate of an nbits chunk at snrDb from the wrapped model
+        auto chunkSuccess = [&](double snrDb, uint64_t nbits) {
+            return m_model->GetChunkSuccessRate(mode,
+                                                txVector,
+                                                std::pow(10.0, snrDb / 10),
+                                                nbits,
+                                                1,
+                                                field,
+                                                staId);
+        };
+        // per-bit log success rate ln(1 - pe) at snrDb. A ReferenceBits chunk resolves
+        // a tiny pe best, but its rate underflows once pe is above a few percent; the
+        // rate of a single bit, 1 - pe, then still holds the value.
+        auto perBit = [&](double snrDb) {
+            double csr = chunkSuccess(snrDb, m_referenceBits);
+            if (csr >= std::numeric_limits<double>::min())
+            {
+                return std::log(csr) / m_referenceBits;
+            }
+            return std::max(std::log1p(chunkSuccess(snrDb, 1) - 1), MIN_LOG_SUCCESS);
+        };
+
+        std::size_t points = static_cast<std::size_t>(std::ceil((m_maxSnrDb - m_minSnrDb) / m_stepDb)) + 1;
+        Table &table = (*m_tables)[key];
+        table.resize(points);
+        for (std::size_t i = 0; i < points; ++i)
+        {
+            table[i] = perBit(m_minSnrDb + i * m_stepDb);
+        }
+
+        // checked at the midpoints, where the interpolation is furthest from the grid,
+        // for a long and a short chunk: their errors peak in different SNR ranges
+        double maxError = 0;
+        for (uint64_t nbits : {SHORT_CHUNK_BITS, m_referenceBits})
+        {
+            double error = 0;
+            for (std::size_t i = 0; i + 1 < points; ++i)
+            {
+                double snrDb = m_minSnrDb + (i + 0.5) * m_stepDb;
+                double exact = chunkSuccess(snrDb, nbits);
+                double interpolated = std::exp(nbits * Lookup(table, snrDb));
+                error = std::max(error, std::abs(exact - interpolated));
+            }
+            if (error > m_tolerance)
+            {
+                NS_LOG_WARN("Table for " << key.first << " is off by up to " << error << " at "
+                                         << nbits << " bits, lower Step");
+            }
+            maxError = std::max(maxError, error);
+        }
+        m_maxTableError = std::max(m_maxTableError, maxError);
+        NS_LOG_DEBUG("Built table for " << key.first << " field " << key.second
+                                        << ", max error " << maxError);
+        SaveCache(m_signature);
+        return table;
+    }
+
+    double
+    TableErrorRateModel::Lookup(const Table &table, double snrDb) const
+    {
+        double x = (snrDb - m_minSnrDb) / m_stepDb;
+        if (!(x > 0)) // also catches -inf for a zero SNR
+        {
+            return table.front();
+        }
+        if (x >= table.size() - 1)
+        {
+            return table.back();
+        }
+        std::size_t i = static_cast<std::size_t>(x);
+        double t = x - i;
+        return table[i] + t * (table[i + 1] - table[i]);
+    }
+
+    double
+    TableErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
+                                               const WifiTxVector &txVector,
+                                               double snr,
+                                               uint64_t nbits,
+                                               uint8_t numRxAntennas,
+                                               WifiPpduField field,
+                                               uint16_t staId) const
+    {
+        if (numRxAntennas != 1 || txVector.GetNss(staId) != 1)
+        {
+            return m_model->GetChunkSuccessRate(mode, txVector, snr, nbits, numRxAntennas, field, staId);
+        }
+        const Table &table = GetTable(mode, txVector, field, staId);
+        return std::exp(nbits * Lookup(table, 10 * std::log10(snr)));
+    }
+
+    std::string
+    TableErrorRateModel::CacheSignature() const
+    {
+        std::ostringstream os;
+        os << std::setprecision(17) << "v" << TABLE_FORMAT << " "
+           << m_model->GetInstanceTypeId().GetName() << " " << m_minSnrDb
+           << " " << m_maxSnrDb << " " << m_stepDb << " " << m_referenceBits;
+        return os.str();
+    }
+
+    // Cache file format, one table per line:
+    //   v<format> <error rate model> <min snr> <max snr> <step> <reference bits> <mode> <field> <points> <values...>
+    // Lines for another model or grid are kept but ignored.
+    void
+    TableErrorRateModel::LoadCache(const std::string &signature) const
+    {
+        if (m_cacheFile.empty())
+        {
+            return;
+        }
+        std::ifstream in(m_cacheFile);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.compare(0, signature.size() + 1, signature + " ") != 0)
+            {
+                continue;
+            }
+            std::istringstream is(line.substr(signature.size() + 1));
+            TableKey key;
+            std::size_t points;
+            if (!(is >> key.first >> key.second >> points))
+            {
+                continue;
+            }
+            Table table(points);
+            for (double &value : table)
+            {
+                is >> value;
+            }
+            if (is && m_tables->find(key) == m_tables->end())
+            {
+                (*m_tables)[key] = table;
+            }
+        }
+        NS_LOG_DEBUG("Have " << m_tables->size() << " tables after reading " << m_cacheFile);
+    }
+
+    void
+    TableErrorRateModel::SaveCache(const std::string &signature) const
+    {
+        if (m_cacheFile.empty())
+        {
+            return;
+        }
+        // keep what other runs wrote meanwhile, then replace the file atomically so
+        // concurrent runs never read a partial one. Readers need no lock, but two runs
+        // saving at once would each rename their own merge over the other's and drop its
+        // tables, so the read-merge-rename is serialised on a side file.
+        FileLock lock(m_cacheFile + ".lock");
+        std::map<TableKey, std::string> lines;
+        std::vector<std::string> otherLines;
+        {
+            std::ifstream in(m_cacheFile);
+            std::string line;
+            while (std::getline(in, line))
+            {
+                std::istringstream is(line.compare(0, signature.size() + 1, signature + " ") == 0
+                                          ? line.substr(signature.size() + 1)
+                                          : std::string());
+                TableKey key;
+                if (is >> key.first >> key.second)
+                {
+                    lines[key] = line;
+                }
+                else
+                {
+                    otherLines.push_back(line);
+                }
+            }
+        }
+        for (const auto &entry : *m_tables)
+        {
+            std::ostringstream os;
+            os << std::setprecision(17) << signature << " " << entry.first.first << " "
+               << entry.first.second << " " << entry.second.size();
+            for (double value : entry.second)
+            {
+                os << " " << value;
+            }
+            lines[entry.first] = os.str();
+        }
+
+        std::string temporary = m_cacheFile + "." + std::to_string(getpid());
+        {
+            std::ofstream out(temporary);
+            for (const std::string &line : otherLines)
+            {
+                out << line << "\n";
+            }
+            for (const auto &entry : lines)
+            {
+                out << entry.second << "\n";
+            }
+            if (!out)
+            {
+                NS_LOG_WARN("Could not write " << temporary);
+                std::remove(temporary.c_str());
+                return;
+            }
+        }
+        if (std::rename(temporary.c_str(), m_cacheFile.c_str()) != 0)
+        {
+            NS_LOG_WARN("Could not replace " << m_cacheFile);
+            std::remove(temporary.c_str());
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * Author: Diego R Cruz
+ *
+ * Place this onto the model folder in ns3
+ * ns-allinone-3.39/ns-3.39/src/wifi/model/
+ *
+ * Don't forget to edit the Cmake list txt under the same folder:
+ * ns-allinone-3.39/ns-3.39/src/wifi/CMakeLists.txt
+ */
+
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include "ns3/error-rate-model.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-phy-common.h"
+#include "ns3/wifi-tx-vector.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+    /**
+     * Error rate model answering chunk success rates from SINR lookup tables built out
+     * of another (analytical) error rate model, NistErrorRateModel by default.
+     *
+     * Nist and Yans both compute the success rate of an nbits chunk as (1 - pe(snr))^nbits,
+     * so a table of the per-bit log success rate ln(1 - pe) over an SNR grid covers
+     * every chunk and packet size: csr = exp(nbits * table(snr)), interpolated linearly in
+     * dB. Grid points come from ln(csr) / ReferenceBits, or from a 1-bit chunk where the
+     * ReferenceBits rate underflows. One table is kept per mode and PPDU field, built the
+     * first time that pair is seen. Each build checks the table at the grid midpoints
+     * against the wrapped model and warns when the success rate of a ReferenceBits or a
+     * 24-bit chunk is off by more than Tolerance.
+     *
+     * Tables are shared by every instance in the process with the same wrapped model and
+     * grid, so the PHYs of a scenario build each table once. With CacheFile set, tables
+     * are read from that file on first use and each new one is merged back into it right
+     * away, so later runs (and forked workers) skip the build. Merges from concurrent
+     * processes are serialised by an flock on CacheFile + ".lock".
+     *
+     * That only holds for models that compute (1 - pe)^nbits, so the wrapped model must be
+     * NistErrorRateModel or YansErrorRateModel; SetErrorRateModel aborts on any other
+     * (TableBasedErrorRateModel, for one, depends on the size through its own tables).
+     *
+     * DSSS and HR/DSSS chunks never reach an ErrorRateModel subclass (ErrorRateModel
+     * handles them itself), so this only speeds up OFDM and later PHYs. MIMO chunks and
+     * chunks received on several antennas go straight to the wrapped model.
+     */
+    class TableErrorRateModel : public ErrorRateModel
+    {
+    public:
+        static TypeId GetTypeId(); // Returns object TypeId
+        TableErrorRateModel();
+
+        TableErrorRateModel(const TableErrorRateModel &) = delete;
+        TableErrorRateModel &operator=(const TableErrorRateModel &) = delete;
+
+        // Model the tables are built from, NistErrorRateModel or YansErrorRateModel
+        void SetErrorRateModel(Ptr<ErrorRateModel> model);
+        Ptr<ErrorRateModel> GetErrorRateModel() const;
+
+        // Largest success rate error of a ReferenceBits or 24-bit chunk over all tables built
+        double GetMaxTableError() const;
+
+        // Number of tables in memory
+        std::size_t GetTableCount() const;
+
+    protected:
+        void DoDispose() override;
+
+    private:
+        double DoGetChunkSuccessRate(WifiMode mode,
+                                     const WifiTxVector &txVector,
+                                     double snr,
+                                     uint64_t nbits,
+                                     uint8_t numRxAntennas,
+                                     WifiPpduField field,
+                                     uint16_t staId) const override;
+
+        // Per-bit log success rate ln(1 - pe) at each grid point
+        typedef std::vector<double> Table;
+        // Mode unique name and PPDU field
+        typedef std::pair<std::string, int> TableKey;
+
+        const Table &GetTable(WifiMode mode,
+                              const WifiTxVector &txVector,
+                              WifiPpduField field,
+                              uint16_t staId) const;
+        double Lookup(const Table &table, double snrDb) const;
+
+        // Cache file line prefix identifying the wrapped model, grid and reference size
+        std::string CacheSignature() const;
+        // Tables of every instance with the given signature
+        static std::map<TableKey, Table> &SharedTables(const std::string &signature);
+        void LoadCache(const std::string &signature) const;
+        void SaveCache(const std::string &signature) const;
+
+        Ptr<ErrorRateModel> m_model; // wrapped model
+        double m_minSnrDb;           // first grid point
+        double m_maxSnrDb;           // last grid point
+        double m_stepDb;             // grid spacing
+        uint64_t m_referenceBits;    // chunk size the tolerance is checked at
+        double m_tolerance;          // acceptable success rate error at m_referenceBits
+        std::string m_cacheFile;     // tables on disk, empty for none
+
+        mutable std::map<TableKey, Table> *m_tables; // shared tables, null until first use
+        mutable std::string m_signature;            // signature m_tables belongs to
+        mutable double m_maxTableError;
+    };
+} // namespace ns3
+#endif
@@ -20,13 +20,45 @@
  *
  * Topology: [node 0] <-- -50 dB --> [node 1] <-- -50 dB --> [node 2]
  *
+ * --nodes=N generalises this to N nodes where node 1 receives a CBR stream from every
+ * other node, and --hidden lists the pairs ("0-2,3-4", or "all" for every pair of
+ * senders) that cannot hear each other. The losses live in a
+ * SymmetricMatrixPropagationLossModel so lookups stay O(1) at a few hundred nodes.
+ * At most 901 nodes fit, as every sender's ARP ping must be done within the warm-up.
+ *
  * This example illustrates the use of
  *  - Wifi in ad-hoc mode
  *  - Matrix propagation loss model
  *  - Use of OnOffApplication to generate CBR stream
  *  - IP flow monitor
+ *
+ * With --matrix every (RTS/CTS, manager, seed) combination runs in its own forked
+ * worker process, since Simulator is a per-process singleton, with at most --jobs
+ * workers at a time. Workers send their flow statistics back over a pipe and the
+ * parent prints one summary table.
+ * Runs that only differ in RTS/CTS share a worker that simulates the warm-up once
+ * and forks at its end (--warmupFork, on by default).
+ *
+ * --ciWidth ends a run once the batch-means throughput of every flow has converged,
+ * instead of always simulating to --maxTime; throughput is over the actual window.
+ *
+ * --bench runs every manager once per RTS/CTS setting and reports what the run cost
+ * to simulate (wall-clock time, events, events/s, peak RSS) next to its throughput.
+ * With an OFDM --standard it runs each with and without --phyAbstraction and checks
+ * the throughput difference against --phyTolerance, next to the measured speedup.
+ *
+ * --phyAbstraction replaces the Nist error rate model by table lookups
+ * (TableErrorRateModel). It needs an OFDM --standard, 802.11b DSSS receptions are
+ * decided before any ErrorRateModel subclass is asked.
+ *
+ * --predict solves a Bianchi DCF model extended for hidden nodes instead of simulating,
+ * and --validatePredict compares it with simulations over a grid of topologies.
+ *
+ * --sweep maps throughput and fairness over RtsCtsThreshold x packet size x offered
+ * load, refining the grid where neighbouring points differ.
  */
 
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
 #include "ns3/command-line.h"
 #include "ns3/config.h"
@@ -38,49 +70,300 @@
 #include "ns3/on-off-helper.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/string.h"
+#include "ns3/symmetric-matrix-propagation-loss-model.h"
+#include "ns3/table-error-rate-model.h"
 #include "ns3/udp-echo-helper.h"
 #include "ns3/uinteger.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 using namespace ns3;
 
 // ./ns3 run "scratch/wifi-hidden-terminal"
+// ./ns3 run "scratch/wifi-hidden-terminal --matrix --seeds=30"
+// ./ns3 run "scratch/wifi-hidden-terminal --bench"
+// ./ns3 run "scratch/wifi-hidden-terminal --bench --standard=80211a --managers=Ideal,Minstrel"
+// ./ns3 run "scratch/wifi-hidden-terminal --predict --hidden=0-2"
 
+/// End of the simulation, unless it converges earlier
+const Time SIMULATION_END = Seconds(10);
 /**
- * Run single 10 seconds experiment
+ * End of the warm-up: the echo pings that prime ARP are done and no CBR packet has
+ * been sent. Stop() is called before Run() initializes the nodes, so its event runs
+ * ahead of the OnOff start events scheduled for the same time stamp.
+ */
+const Time WARMUP_END = Seconds(1.0);
+/// Largest MPDU of the warm-up, an echo ping: 10 bytes + UDP, IP, LLC/SNAP, MAC and FCS
+const uint32_t WARMUP_MPDU_BYTES = 10 + 8 + 20 + 8 + 28;
+/// Spacing of the echo pings, compressed down to MIN_ECHO_SPACING for large topologies
+const Time ECHO_SPACING = MilliSeconds(5);
+/// Closest spacing at which the pings and their ARP exchanges still fit the warm-up
+const Time MIN_ECHO_SPACING = MilliSeconds(1);
+/// Part of the warm-up after the last ping starts, left for its ARP exchange and retries
+const Time ECHO_TAIL = MilliSeconds(100);
+/// Destination ports that tell the flows apart in CollectFlows and ConvergenceMonitor
+const uint16_t CBR_PORT = 12345;
+const uint16_t ECHO_PORT = 9;
+
+/// One run of the experiment
+struct ExperimentConfig
+{
+    bool enableCtsRts;       ///< RTS/CTS for packets larger than 100 bytes
+    std::string wifiManager; ///< rate manager, without the ns3:: prefix and WifiManager suffix
+    uint64_t run;            ///< RngRun
+    uint32_t nodes = 3;      ///< node 1 receives, every other node sends
+    std::vector<std::pair<uint32_t, uint32_t>> hiddenPairs; ///< node pairs out of range
+    Time maxTime = SIMULATION_END;   ///< end of the simulation at the latest
+    double ciWidth = 0;              ///< convergence threshold, see ConvergenceMonitor, 0 never
+    Time batchLength = Seconds(0.5); ///< batch length of the convergence monitor
+    std::string standard = "80211b"; ///< 80211b, 80211a or 80211g
+    bool phyAbstraction = false;     ///< TableErrorRateModel instead of Nist, OFDM only
+    std::string perTableFile;        ///< cache file of the TableErrorRateModel tables
+    uint32_t packetSize = 1400;      ///< CBR payload (bytes)
+    uint64_t dataRate = 3000000;     ///< CBR rate (bps) of flow 1, each next flow adds 1100 bps
+    uint32_t rtsCtsThreshold = 0;    ///< RtsCtsThreshold (bytes), 0 to follow enableCtsRts
+};
+
+/// Loss between nodes that hear each other, as per hw03 instructions
+const double LINK_LOSS = 50;
+/// Loss between hidden nodes (no link)
+const double HIDDEN_LOSS = 200;
+
+/// Statistics of one CBR flow, plain data so it can go through a pipe
+struct FlowResult
+{
+    uint32_t flowId; ///< sender index + 1, "flow s + 1" in BuildScenario
+    uint32_t source; ///< IPv4 addresses
+    uint32_t destination;
+    uint64_t txPackets;
+    uint64_t txBytes;
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+    double window; ///< measurement window (s), from WARMUP_END to the end of the run
+};
+
+/// Whether flowId is a CBR flow rather than an echo ping
+static bool
+IsCbrFlow(Ptr<Ipv4FlowClassifier> classifier, FlowId flowId)
+{
+    return classifier->FindFlow(flowId).destinationPort == CBR_PORT;
+}
+
+/// Throughput in Mbps of bytes over window seconds
+static double
+Mbps(uint64_t bytes, double window)
+{
+    return bytes * 8.0 / window / 1000 / 1000;
+}
+
+/**
+ * Ends a run once the throughput of every CBR flow has converged.
  *
- * \param enableCtsRts if true, enable RTS/CTS for packets larger than 100 bytes.
- * \param wifiManager WiFi manager to use.
+ * From WARMUP_END on, the rx bytes of each flow are sampled every batch length and the
+ * throughput of each batch is recorded (batch means). The first batch holds the
+ * start-up transient of the rate managers and is dropped. Once at least minBatches
+ * batches are in, the simulation is stopped when the 95% confidence half-width of every
+ * flow's batch mean is at most ciWidth times the mean total throughput. Relating the
+ * width to the total keeps flows starved by a hidden terminal from never converging.
  */
-void experiment(bool enableCtsRts, std::string wifiManager)
+class ConvergenceMonitor
 {
-    // 0. Enable or disable CTS/RTS
-    UintegerValue ctsThr = (enableCtsRts ? UintegerValue(100) : UintegerValue(2200));
-    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThr);
+  public:
+    /**
+     * \param monitor FlowMonitor of the run
+     * \param classifier classifier of the FlowMonitor, to skip the echo pings
+     * \param batchLength interval between samples
+     * \param ciWidth relative half-width threshold
+     */
+    ConvergenceMonitor(Ptr<FlowMonitor> monitor,
+                       Ptr<Ipv4FlowClassifier> classifier,
+                       Time batchLength,
+                       double ciWidth)
+        : m_monitor(monitor),
+          m_classifier(classifier),
+          m_batchLength(batchLength),
+          m_ciWidth(ciWidth),
+          m_samples(0)
+    {
+    }
+
+    /// Schedules the first sample at WARMUP_END
+    void Start()
+    {
+        Simulator::Schedule(WARMUP_END - Simulator::Now(), &ConvergenceMonitor::Sample, this);
+    }
+
+    /// Batches needed before convergence is tested, counting the dropped one
+    static const uint32_t MIN_BATCHES = 11;
+
+  private:
+    /// 97.5% quantile of Student's t with df degrees of freedom
+    static double StudentT975(uint32_t df)
+    {
+        static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                       2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                       2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                       2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+        return df <= 30 ? table[df - 1] : 1.96;
+    }
+
+    void Sample()
+    {
+        FlowMonitor::FlowStatsContainer stats = m_monitor->GetFlowStats();
+        for (const auto &flow : stats)
+        {
+            if (!IsCbrFlow(m_classifier, flow.first))
+            {
+                continue;
+            }
+            uint64_t &last = m_lastRxBytes[flow.first];
+            if (m_samples > 1)
+            {
+                m_batches[flow.first].push_back(Mbps(flow.second.rxBytes - last,
+                                                     m_batchLength.GetSeconds()));
+            }
+            last = flow.second.rxBytes;
+        }
+        m_samples++;
+
+        if (m_samples >= MIN_BATCHES + 1 && Converged())
+        {
+            Simulator::Stop();
+            return;
+        }
+        Simulator::Schedule(m_batchLength, &ConvergenceMonitor::Sample, this);
+    }
+
+    bool Converged() const
+    {
+        double total = 0;
+        std::vector<double> halfWidths;
+        for (const auto &flow : m_batches)
+        {
+            const std::vector<double> &batches = flow.second;
+            if (batches.size() < 2)
+            {
+                return false;
+            }
+            double mean = 0;
+            for (double batch : batches)
+            {
+                mean += batch;
+            }
+            mean /= batches.size();
+            double sumSq = 0;
+            for (double batch : batches)
+            {
+                sumSq += (batch - mean) * (batch - mean);
+            }
+            total += mean;
+            halfWidths.push_back(StudentT975(batches.size() - 1) *
+                                 std::sqrt(sumSq / (batches.size() - 1) / batches.size()));
+        }
+        if (halfWidths.empty() || total <= 0)
+        {
+            return false;
+        }
+        for (double halfWidth : halfWidths)
+        {
+            if (halfWidth > m_ciWidth * total)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Ptr<FlowMonitor> m_monitor;
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    Time m_batchLength;
+    double m_ciWidth;
+    uint32_t m_samples;                            ///< samples taken, the first only sets the baseline
+    std::map<FlowId, uint64_t> m_lastRxBytes;      ///< rx bytes at the previous sample
+    std::map<FlowId, std::vector<double>> m_batches; ///< throughput (Mbps) per batch
+};
+
+/// RTS/CTS threshold of the run: the explicit one, else RTS/CTS for packets larger than
+/// 100 bytes or never
+static UintegerValue
+RtsCtsThreshold(const ExperimentConfig &config)
+{
+    if (config.rtsCtsThreshold)
+    {
+        return UintegerValue(config.rtsCtsThreshold);
+    }
+    return config.enableCtsRts ? UintegerValue(100) : UintegerValue(2200);
+}
+
+/**
+ * Builds the topology, devices and applications of one experiment
+ *
+ * \param config WiFi manager to use and topology, RTS/CTS comes from the attribute default.
+ * \param flowmon helper that installs the FlowMonitor, must outlive the simulation
+ * \return the FlowMonitor
+ */
+Ptr<FlowMonitor> BuildScenario(const ExperimentConfig &config, FlowMonitorHelper &flowmon)
+{
+    const std::string &wifiManager = config.wifiManager;
 
-    // 1. Create 3 nodes
+    // 1. Create nodes, node 1 is the receiver
+    NS_ABORT_MSG_IF(config.nodes < 2, "need a receiver and at least one sender");
     NodeContainer nodes;
-    nodes.Create(3);
+    nodes.Create(config.nodes);
+    const uint32_t senders = config.nodes - 1;
+    // node of the s-th sender, skipping the receiver
+    auto sender = [&nodes](uint32_t s) { return nodes.Get(s == 0 ? 0 : s + 1); };
 
     // 2. Place nodes somehow, this is required by every wireless simulation
-    for (uint8_t i = 0; i < 3; ++i)
+    for (uint32_t i = 0; i < config.nodes; ++i)
     {
         nodes.Get(i)->AggregateObject(CreateObject<ConstantPositionMobilityModel>());
     }
 
     // 3. Create propagation loss matrix
-    Ptr<MatrixPropagationLossModel> lossModel = CreateObject<MatrixPropagationLossModel>();
-    // lossModel->SetDefaultLoss(200); // set default loss to 200 dB (no link)
-    lossModel->SetDefaultLoss(50); // set default loss to 50 as per hw03 instructions
+    Ptr<SymmetricMatrixPropagationLossModel> lossModel =
+        CreateObject<SymmetricMatrixPropagationLossModel>();
+    lossModel->SetNodeCount(config.nodes);
+    // lossModel->SetDefaultLoss(HIDDEN_LOSS); // set default loss to 200 dB (no link)
+    lossModel->SetDefaultLoss(LINK_LOSS); // set default loss to 50 as per hw03 instructions
 
-    lossModel->SetLoss(nodes.Get(0)->GetObject<MobilityModel>(),
-                       nodes.Get(1)->GetObject<MobilityModel>(),
-                       50); // set symmetric loss 0 <-> 1 to 50 dB
-    lossModel->SetLoss(nodes.Get(2)->GetObject<MobilityModel>(),
-                       nodes.Get(1)->GetObject<MobilityModel>(),
-                       50); // set symmetric loss 2 <-> 1 to 50 dB
+    for (uint32_t s = 0; s < senders; ++s)
+    {
+        // set symmetric loss sender <-> 1 to 50 dB
+        lossModel->SetLoss(sender(s)->GetId(), nodes.Get(1)->GetId(), LINK_LOSS);
+    }
+    for (const std::pair<uint32_t, uint32_t> &pair : config.hiddenPairs)
+    {
+        NS_ABORT_MSG_IF(pair.first >= config.nodes || pair.second >= config.nodes ||
+                            pair.first == pair.second,
+                        "bad hidden pair " << pair.first << "-" << pair.second);
+        lossModel->SetLoss(nodes.Get(pair.first)->GetId(),
+                           nodes.Get(pair.second)->GetId(),
+                           HIDDEN_LOSS);
+    }
 
     // 4. Create & setup wifi channel
     Ptr<YansWifiChannel> wifiChannel = CreateObject<YansWifiChannel>();
@@ -89,10 +372,39 @@ void experiment(bool enableCtsRts, std::string wifiManager)
 
     // 5. Install wireless devices
     WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
+    if (config.standard == "80211b")
+    {
+        wifi.SetStandard(WIFI_STANDARD_80211b);
+    }
+    else if (config.standard == "80211a")
+    {
+        wifi.SetStandard(WIFI_STANDARD_80211a);
+    }
+    else if (config.standard == "80211g")
+    {
+        wifi.SetStandard(WIFI_STANDARD_80211g);
+    }
+    else
+    {
+        NS_ABORT_MSG("unknown standard " << config.standard);
+    }
     wifi.SetRemoteStationManager("ns3::" + wifiManager + "WifiManager");
     YansWifiPhyHelper wifiPhy;
     wifiPhy.SetChannel(wifiChannel);
+    if (config.phyAbstraction)
+    {
+        // DSSS chunks are decided inside ErrorRateModel itself, tables can't help there
+        NS_ABORT_MSG_IF(config.standard == "80211b",
+                        "--phyAbstraction needs an OFDM standard (80211a or 80211g)");
+        wifiPhy.SetErrorRateModel("ns3::TableErrorRateModel",
+                                  "CacheFile",
+                                  StringValue(config.perTableFile));
+    }
+    else if (config.standard != "80211b")
+    {
+        // the model the tables are built from, so both modes can be compared directly
+        wifiPhy.SetErrorRateModel("ns3::NistErrorRateModel");
+    }
     WifiMacHelper wifiMac;
     wifiMac.SetType("ns3::AdhocWifiMac"); // use ad-hoc MAC
     NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, nodes);
@@ -113,105 +425,1569 @@ void experiment(bool enableCtsRts, std::string wifiManager)
     ipv4.SetBase("10.0.0.0", "255.0.0.0");
     ipv4.Assign(devices);
 
-    // 7. Install applications: two CBR streams each saturating the channel
+    // 7. Install applications: one CBR stream per sender, each saturating the channel
     ApplicationContainer cbrApps;
-    uint16_t cbrPort = 12345;
     OnOffHelper onOffHelper("ns3::UdpSocketFactory",
-                            InetSocketAddress(Ipv4Address("10.0.0.2"), cbrPort));
-    onOffHelper.SetAttribute("PacketSize", UintegerValue(1400));
+                            InetSocketAddress(Ipv4Address("10.0.0.2"), CBR_PORT));
+    onOffHelper.SetAttribute("PacketSize", UintegerValue(config.packetSize));
     onOffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
     onOffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
 
-    // flow 1:  node 0 -> node 1
-    onOffHelper.SetAttribute("DataRate", StringValue("3000000bps"));
-    onOffHelper.SetAttribute("StartTime", TimeValue(Seconds(1.000000)));
-    cbrApps.Add(onOffHelper.Install(nodes.Get(0)));
-
-    // flow 2:  node 2 -> node 1
+    // flow s + 1:  sender s -> node 1, node 0 and node 2 for the classic 3 nodes
     /** \internal
      * The slightly different start times and data rates are a workaround
      * for \bugid{388} and \bugid{912}
      */
-    onOffHelper.SetAttribute("DataRate", StringValue("3001100bps"));
-    onOffHelper.SetAttribute("StartTime", TimeValue(Seconds(1.001)));
-    cbrApps.Add(onOffHelper.Install(nodes.Get(2)));
+    for (uint32_t s = 0; s < senders; ++s)
+    {
+        onOffHelper.SetAttribute("DataRate", StringValue(std::to_string(config.dataRate + 1100 * s) + "bps"));
+        onOffHelper.SetAttribute("StartTime", TimeValue(Seconds(1.0 + 0.001 * s)));
+        cbrApps.Add(onOffHelper.Install(sender(s)));
+    }
 
     /** \internal
      * We also use separate UDP applications that will send a single
      * packet before the CBR flows start.
      * This is a workaround for the lack of perfect ARP, see \bugid{187}
      */
-    uint16_t echoPort = 9;
-    UdpEchoClientHelper echoClientHelper(Ipv4Address("10.0.0.2"), echoPort);
+    UdpEchoClientHelper echoClientHelper(Ipv4Address("10.0.0.2"), ECHO_PORT);
     echoClientHelper.SetAttribute("MaxPackets", UintegerValue(1));
     echoClientHelper.SetAttribute("Interval", TimeValue(Seconds(0.1)));
     echoClientHelper.SetAttribute("PacketSize", UintegerValue(10));
     ApplicationContainer pingApps;
 
-    // again using different start times to workaround Bug 388 and Bug 912
-    echoClientHelper.SetAttribute("StartTime", TimeValue(Seconds(0.001)));
-    pingApps.Add(echoClientHelper.Install(nodes.Get(0)));
-    echoClientHelper.SetAttribute("StartTime", TimeValue(Seconds(0.006)));
-    pingApps.Add(echoClientHelper.Install(nodes.Get(2)));
+    // again using different start times to workaround Bug 388 and Bug 912. Every ping
+    // must be done by WARMUP_END, so large topologies get a closer spacing
+    const Time echoStart = MilliSeconds(1);
+    Time echoSpacing = ECHO_SPACING;
+    if (senders > 1)
+    {
+        echoSpacing = std::min(echoSpacing, (WARMUP_END - ECHO_TAIL - echoStart) / (senders - 1));
+    }
+    NS_ABORT_MSG_IF(echoSpacing < MIN_ECHO_SPACING,
+                    "the echo pings of " << senders << " senders don't fit before WARMUP_END");
+    for (uint32_t s = 0; s < senders; ++s)
+    {
+        echoClientHelper.SetAttribute("StartTime", TimeValue(echoStart + echoSpacing * s));
+        pingApps.Add(echoClientHelper.Install(sender(s)));
+    }
 
     // 8. Install FlowMonitor on all nodes
-    FlowMonitorHelper flowmon;
-    Ptr<FlowMonitor> monitor = flowmon.InstallAll();
-
-    // 9. Run simulation for 10 seconds
-    Simulator::Stop(Seconds(10));
-    Simulator::Run();
+    return flowmon.InstallAll();
+}
 
-    // 10. Print per flow statistics
+/**
+ * Collects the statistics of the CBR flows once the simulation has run
+ *
+ * \param config topology the scenario was built with
+ * \param flowmon helper the FlowMonitor was installed with
+ * \param monitor the FlowMonitor
+ * \return statistics of the CBR flows
+ */
+std::vector<FlowResult> CollectFlows(const ExperimentConfig &config,
+                                     FlowMonitorHelper &flowmon,
+                                     Ptr<FlowMonitor> monitor)
+{
+    std::vector<FlowResult> results;
     monitor->CheckForLostPackets();
     Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
+    // node n has address 10.0.0.n+1, see BuildScenario
+    const uint32_t firstAddress = Ipv4Address("10.0.0.1").Get();
     FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats();
     for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin();
          i != stats.end();
          ++i)
     {
-        // first 2 FlowIds are for ECHO apps, we don't want to display them
+        // the ECHO apps' flows go to ECHO_PORT, we don't want to display them. FlowIds
+        // follow the first packet of each flow, so the two kinds may interleave.
         //
-        // Duration for throughput measurement is 9.0 seconds, since
+        // Duration for throughput measurement is 9.0 seconds for a full run, since
         //   StartTime of the OnOffApplication is at about "second 1"
         // and
-        //   Simulator::Stops at "second 10".
-        if (i->first > 2)
+        //   Simulator::Stops at "second 10",
+        // or shorter when the ConvergenceMonitor stopped it earlier.
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
+        if (t.destinationPort == CBR_PORT)
         {
-            Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
-            std::cout << "Flow " << i->first - 2 << " (" << t.sourceAddress << " -> "
-                      << t.destinationAddress << ")\n";
-            std::cout << "  Tx Packets: " << i->second.txPackets << "\n";
-            std::cout << "  Tx Bytes:   " << i->second.txBytes << "\n";
-            std::cout << "  TxOffered:  " << i->second.txBytes * 8.0 / 9.0 / 1000 / 1000
-                      << " Mbps\n";
-            std::cout << "  Rx Packets: " << i->second.rxPackets << "\n";
-            std::cout << "  Rx Bytes:   " << i->second.rxBytes << "\n";
-            std::cout << "  Throughput: " << i->second.rxBytes * 8.0 / 9.0 / 1000 / 1000
-                      << " Mbps\n";
+            // sender s is node 0 for s = 0 and node s + 1 otherwise
+            uint32_t node = t.sourceAddress.Get() - firstAddress;
+            FlowResult result;
+            result.flowId = node == 0 ? 1 : node;
+            result.source = t.sourceAddress.Get();
+            result.destination = t.destinationAddress.Get();
+            result.txPackets = i->second.txPackets;
+            result.txBytes = i->second.txBytes;
+            result.rxPackets = i->second.rxPackets;
+            result.rxBytes = i->second.rxBytes;
+            result.window = (Simulator::Now() - WARMUP_END).GetSeconds();
+            results.push_back(result);
         }
     }
+    std::sort(results.begin(), results.end(), [](const FlowResult &a, const FlowResult &b) {
+        return a.flowId < b.flowId;
+    });
+    return results;
+}
+
+/**
+ * Runs the scenario from the current time to its end, maxTime or convergence
+ *
+ * \param config run length and convergence settings
+ * \param flowmon helper the FlowMonitor was installed with
+ * \param monitor FlowMonitor of the run
+ */
+static void
+RunToEnd(const ExperimentConfig &config, FlowMonitorHelper &flowmon, Ptr<FlowMonitor> monitor)
+{
+    std::unique_ptr<ConvergenceMonitor> convergence;
+    if (config.ciWidth > 0)
+    {
+        convergence = std::make_unique<ConvergenceMonitor>(
+            monitor,
+            DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier()),
+            config.batchLength,
+            config.ciWidth);
+        convergence->Start();
+    }
+    Simulator::Stop(config.maxTime - Simulator::Now());
+    Simulator::Run();
+}
+
+/// Simulator cost of one run, plain data so it can go through a pipe
+struct RunCost
+{
+    double buildSeconds; ///< wall-clock time spent building the scenario
+    double runSeconds;   ///< wall-clock time spent in Simulator::Run
+    uint64_t events;     ///< events executed
+};
+
+/// Wall-clock seconds elapsed since start
+static double
+SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Run single experiment, 10 seconds unless configured otherwise
+ *
+ * \param config RTS/CTS setting, WiFi manager to use, RngRun and topology.
+ * \param cost if not null, receives the wall-clock time and event count of the run
+ * \return statistics of the CBR flows
+ */
+std::vector<FlowResult> experiment(const ExperimentConfig &config, RunCost *cost = nullptr)
+{
+    auto start = std::chrono::steady_clock::now();
+    RngSeedManager::SetRun(config.run);
+
+    // 0. Enable or disable CTS/RTS
+    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold",
+                       RtsCtsThreshold(config));
+
+    // 1.-8. Build the scenario
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor = BuildScenario(config, flowmon);
+
+    double buildSeconds = SecondsSince(start);
+
+    // 9. Run simulation for 10 seconds, or until the throughput converged
+    start = std::chrono::steady_clock::now();
+    RunToEnd(config, flowmon, monitor);
+    if (cost)
+    {
+        cost->buildSeconds = buildSeconds;
+        cost->runSeconds = SecondsSince(start);
+        cost->events = Simulator::GetEventCount();
+    }
+
+    // 10. Collect per flow statistics
+    std::vector<FlowResult> results = CollectFlows(config, flowmon, monitor);
 
     // 11. Cleanup
     Simulator::Destroy();
+    return results;
+}
+
+/// Prints the flows the way a single experiment always has
+void PrintFlows(const std::vector<FlowResult> &results)
+{
+    for (const FlowResult &flow : results)
+    {
+        std::cout << "Flow " << flow.flowId << " (" << Ipv4Address(flow.source) << " -> "
+                  << Ipv4Address(flow.destination) << ")\n";
+        std::cout << "  Tx Packets: " << flow.txPackets << "\n";
+        std::cout << "  Tx Bytes:   " << flow.txBytes << "\n";
+        std::cout << "  TxOffered:  " << Mbps(flow.txBytes, flow.window) << " Mbps\n";
+        std::cout << "  Rx Packets: " << flow.rxPackets << "\n";
+        std::cout << "  Rx Bytes:   " << flow.rxBytes << "\n";
+        std::cout << "  Throughput: " << Mbps(flow.rxBytes, flow.window) << " Mbps\n";
+    }
+}
+
+/// Reads exactly size bytes from fd, false on EOF or error
+static bool
+ReadAll(int fd, void *buffer, size_t size)
+{
+    char *out = static_cast<char *>(buffer);
+    while (size > 0)
+    {
+        ssize_t got = read(fd, out, size);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            return false;
+        }
+        out += got;
+        size -= got;
+    }
+    return true;
+}
+
+/// Writes all size bytes to fd, false on error
+static bool
+WriteAll(int fd, const void *buffer, size_t size)
+{
+    const char *in = static_cast<const char *>(buffer);
+    while (size > 0)
+    {
+        ssize_t put = write(fd, in, size);
+        if (put < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (put <= 0)
+        {
+            return false;
+        }
+        in += put;
+        size -= put;
+    }
+    return true;
+}
+
+/// Writes the flow count and the FlowResult array to fd, false on error
+static bool
+WriteFlows(int fd, const std::vector<FlowResult> &flows)
+{
+    uint32_t count = flows.size();
+    return WriteAll(fd, &count, sizeof(count)) &&
+           WriteAll(fd, flows.data(), count * sizeof(FlowResult));
+}
+
+/// Reads what WriteFlows wrote, empty on a short read
+static std::vector<FlowResult>
+ReadFlows(int fd)
+{
+    std::vector<FlowResult> flows;
+    uint32_t count = 0;
+    if (ReadAll(fd, &count, sizeof(count)))
+    {
+        flows.resize(count);
+        if (!ReadAll(fd, flows.data(), count * sizeof(FlowResult)))
+        {
+            flows.clear();
+        }
+    }
+    return flows;
+}
+
+/// Decodes what WriteFlows wrote into bytes, empty if it is truncated
+static std::vector<FlowResult>
+DecodeFlows(const std::vector<char> &bytes)
+{
+    std::vector<FlowResult> flows;
+    uint32_t count = 0;
+    if (bytes.size() >= sizeof(count))
+    {
+        std::memcpy(&count, bytes.data(), sizeof(count));
+        if (bytes.size() == sizeof(count) + count * sizeof(FlowResult))
+        {
+            flows.resize(count);
+            std::memcpy(flows.data(), bytes.data() + sizeof(count), count * sizeof(FlowResult));
+        }
+    }
+    return flows;
+}
+
+/**
+ * Runs configurations that only differ in RTS/CTS from one shared warm-up.
+ *
+ * The scenario is built and simulated up to WARMUP_END once. Until then only the echo
+ * pings and ARP are on the air, none larger than WARMUP_MPDU_BYTES, so the warm-up is
+ * the same for every variant whose threshold is at least that. The process then forks a child per variant
+ * but the last, which it runs itself. Each variant sets RtsCtsThreshold on the live
+ * station managers, simulates to its end and writes its flows to fds[k].
+ *
+ * \param configs all configurations
+ * \param group indices into configs of the variants
+ * \param fds pipe write end per variant
+ * \return true once every variant wrote its flows
+ */
+static bool
+RunFromWarmup(const std::vector<ExperimentConfig> &configs,
+              const std::vector<size_t> &group,
+              const std::vector<int> &fds)
+{
+    const ExperimentConfig &first = configs[group.front()];
+    RngSeedManager::SetRun(first.run);
+    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold",
+                       RtsCtsThreshold(first));
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor = BuildScenario(first, flowmon);
+    Simulator::Stop(WARMUP_END);
+    Simulator::Run();
+
+    std::vector<pid_t> children;
+    bool ok = true;
+    for (size_t k = 0; k < group.size(); ++k)
+    {
+        const bool last = k + 1 == group.size();
+        pid_t pid = last ? 0 : fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork failed: " << std::strerror(errno));
+        if (pid > 0)
+        {
+            children.push_back(pid);
+            continue;
+        }
+
+        const ExperimentConfig &config = configs[group[k]];
+        Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/"
+                    "RtsCtsThreshold",
+                    RtsCtsThreshold(config));
+        RunToEnd(config, flowmon, monitor);
+        ok = WriteFlows(fds[k], CollectFlows(config, flowmon, monitor));
+        if (!last)
+        {
+            _exit(ok ? 0 : 1);
+        }
+    }
+
+    for (pid_t child : children)
+    {
+        int status;
+        while (waitpid(child, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    return ok;
+}
+
+/**
+ * Runs every configuration in a forked worker process, at most jobs at a time.
+ *
+ * A worker runs experiment() in its own copy of the Simulator and writes its flows to
+ * a pipe before exiting. With warmupFork, configurations that only differ in the RTS/CTS
+ * threshold share one worker that runs the warm-up once and forks at WARMUP_END, see
+ * RunFromWarmup; such a worker counts as one job per variant. The parent polls the
+ * pipes of every running worker and reads them as the data arrives, because a worker
+ * blocks in WriteFlows once its flows outgrow the pipe buffer (64 KiB on Linux, about
+ * 1,100 flows). A worker is reaped when all of its pipes reach end of file, and then
+ * the next one starts.
+ *
+ * The rate manager and RngRun stay part of the warm-up: the manager picks the rates of
+ * the warm-up frames and cannot be replaced on a running device, and the random streams
+ * are seeded when the scenario is built.
+ *
+ * \param configs configurations to run
+ * \param jobs maximum number of concurrent simulations
+ * \param warmupFork share the warm-up between RTS/CTS variants
+ * \return results[i] holds the flows of configs[i], empty if the worker failed
+ */
+std::vector<std::vector<FlowResult>> RunParallel(const std::vector<ExperimentConfig> &configs,
+                                                 unsigned int jobs,
+                                                 bool warmupFork)
+{
+    // configurations that can share a warm-up
+    std::vector<std::vector<size_t>> groups;
+    std::map<std::tuple<std::string,
+                        uint64_t,
+                        uint32_t,
+                        std::vector<std::pair<uint32_t, uint32_t>>,
+                        std::string,
+                        uint32_t,
+                        uint64_t>,
+             size_t>
+        groupOf;
+    for (size_t i = 0; i < configs.size(); ++i)
+    {
+        const ExperimentConfig &config = configs[i];
+        auto key = std::make_tuple(config.wifiManager,
+                                   config.run,
+                                   config.nodes,
+                                   config.hiddenPairs,
+                                   config.standard,
+                                   config.packetSize,
+                                   config.dataRate);
+        auto group = groupOf.find(key);
+        // thresholds below the warm-up frames would change the warm-up itself
+        bool shareable = RtsCtsThreshold(config).Get() >= WARMUP_MPDU_BYTES;
+        if (!warmupFork || !shareable)
+        {
+            groups.push_back({i});
+        }
+        else if (group == groupOf.end())
+        {
+            groupOf[key] = groups.size();
+            groups.push_back({i});
+        }
+        else
+        {
+            groups[group->second].push_back(i);
+        }
+    }
+
+    struct Worker
+    {
+        size_t group;
+        std::vector<int> fds;                 // read ends, -1 once at end of file
+        std::vector<std::vector<char>> bytes; // read so far from each pipe
+    };
+
+    std::vector<std::vector<FlowResult>> results(configs.size());
+    std::map<pid_t, Worker> running;
+    unsigned int busy = 0;
+    size_t next = 0;
+    size_t done = 0;
+    std::cout << std::flush; // children must not flush a copy of the parent's buffer
+
+    while (done < groups.size())
+    {
+        while (next < groups.size() && (busy == 0 || busy + groups[next].size() <= jobs))
+        {
+            const std::vector<size_t> &group = groups[next];
+            std::vector<int> readFds;
+            std::vector<int> writeFds;
+            for (size_t k = 0; k < group.size(); ++k)
+            {
+                int fds[2];
+                NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe failed: " << std::strerror(errno));
+                readFds.push_back(fds[0]);
+                writeFds.push_back(fds[1]);
+            }
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork failed: " << std::strerror(errno));
+            if (pid == 0)
+            {
+                for (int fd : readFds)
+                {
+                    close(fd);
+                }
+                bool ok = group.size() == 1
+                              ? WriteFlows(writeFds[0], experiment(configs[group[0]]))
+                              : RunFromWarmup(configs, group, writeFds);
+                // skip the parent's atexit handlers and static destructors
+                _exit(ok ? 0 : 1);
+            }
+            for (int fd : writeFds)
+            {
+                close(fd);
+            }
+            running[pid] = Worker{next, readFds, std::vector<std::vector<char>>(group.size())};
+            busy += group.size();
+            next++;
+        }
+
+        // every write end of a worker is closed once it and its RunFromWarmup children
+        // have exited, so a worker with all pipes at end of file is reaped right away
+        auto worker = std::find_if(running.begin(), running.end(), [](const auto &entry) {
+            return std::all_of(entry.second.fds.begin(), entry.second.fds.end(), [](int fd) {
+                return fd < 0;
+            });
+        });
+        if (worker == running.end())
+        {
+            std::vector<pollfd> polled;
+            for (const auto &entry : running)
+            {
+                for (int fd : entry.second.fds)
+                {
+                    if (fd >= 0)
+                    {
+                        polled.push_back(pollfd{fd, POLLIN, 0});
+                    }
+                }
+            }
+            int ready = poll(polled.data(), polled.size(), -1);
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            NS_ABORT_MSG_IF(ready < 0, "poll failed: " << std::strerror(errno));
+
+            // same order as polled was filled in
+            size_t p = 0;
+            for (auto &entry : running)
+            {
+                for (size_t k = 0; k < entry.second.fds.size(); ++k)
+                {
+                    int &fd = entry.second.fds[k];
+                    if (fd < 0 || polled[p++].revents == 0)
+                    {
+                        continue;
+                    }
+                    char chunk[65536];
+                    ssize_t got = read(fd, chunk, sizeof(chunk));
+                    if (got > 0)
+                    {
+                        std::vector<char> &bytes = entry.second.bytes[k];
+                        bytes.insert(bytes.end(), chunk, chunk + got);
+                    }
+                    else if (got == 0 || errno != EINTR)
+                    {
+                        close(fd);
+                        fd = -1;
+                    }
+                }
+            }
+            continue;
+        }
+
+        int status;
+        while (waitpid(worker->first, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        const std::vector<size_t> &group = groups[worker->second.group];
+        for (size_t k = 0; k < group.size(); ++k)
+        {
+            results[group[k]] = DecodeFlows(worker->second.bytes[k]);
+            if (results[group[k]].empty())
+            {
+                const ExperimentConfig &config = configs[group[k]];
+                std::cerr << "worker for " << config.wifiManager
+                          << (config.enableCtsRts ? " RTS/CTS" : "") << " run " << config.run
+                          << " failed\n";
+            }
+        }
+        busy -= group.size();
+        running.erase(worker);
+        done++;
+    }
+    return results;
+}
+
+/// Mean and 95% confidence half-width (normal approximation) of values
+static void
+MeanAndCi(const std::vector<double> &values, double &mean, double &halfWidth)
+{
+    mean = 0;
+    for (double value : values)
+    {
+        mean += value;
+    }
+    mean /= std::max<size_t>(values.size(), 1);
+    double sumSq = 0;
+    for (double value : values)
+    {
+        sumSq += (value - mean) * (value - mean);
+    }
+    halfWidth = values.size() > 1 ? 1.96 * std::sqrt(sumSq / (values.size() - 1) / values.size()) : 0;
+}
+
+/**
+ * Parses hidden node pairs, "a-b,c-d,..." or "all" for every pair of senders
+ *
+ * \param list pairs to parse
+ * \param nodes number of nodes, node 1 being the receiver
+ * \return the pairs
+ */
+std::vector<std::pair<uint32_t, uint32_t>> ParseHiddenPairs(const std::string &list, uint32_t nodes)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    if (list == "all")
+    {
+        for (uint32_t b = 0; b < nodes; ++b)
+        {
+            for (uint32_t a = 0; a < b; ++a)
+            {
+                if (a != 1 && b != 1)
+                {
+                    pairs.emplace_back(a, b);
+                }
+            }
+        }
+        return pairs;
+    }
+    std::istringstream is(list);
+    std::string item;
+    while (std::getline(is, item, ','))
+    {
+        uint32_t a;
+        uint32_t b;
+        char dash;
+        std::istringstream pair(item);
+        NS_ABORT_MSG_UNLESS((pair >> a >> dash >> b) && dash == '-', "bad hidden pair " << item);
+        pairs.emplace_back(a, b);
+    }
+    return pairs;
+}
+
+/**
+ * Runs managers x {RTS/CTS off, on} x runs 1..seeds of the scenario's topology in
+ * parallel, writes one row per run and flow to tableFile and prints the mean
+ * throughput per manager and mode.
+ */
+void RunMatrix(const ExperimentConfig &scenario,
+               const std::vector<std::string> &managers,
+               uint32_t seeds,
+               unsigned int jobs,
+               bool warmupFork,
+               const std::string &tableFile)
+{
+    std::vector<ExperimentConfig> configs;
+    for (const std::string &manager : managers)
+    {
+        for (bool enableCtsRts : {false, true})
+        {
+            for (uint64_t run = 1; run <= seeds; ++run)
+            {
+                ExperimentConfig config = scenario;
+                config.enableCtsRts = enableCtsRts;
+                config.wifiManager = manager;
+                config.run = run;
+                configs.push_back(config);
+            }
+        }
+    }
+    std::cout << configs.size() << " runs on " << jobs << " worker processes\n" << std::flush;
+
+    std::vector<std::vector<FlowResult>> results = RunParallel(configs, jobs, warmupFork);
+
+    std::ofstream table(tableFile);
+    table << "manager,rtsCts,run,flow,txPackets,txBytes,rxPackets,rxBytes,windowS,throughputMbps\n";
+    for (size_t i = 0; i < configs.size(); ++i)
+    {
+        for (const FlowResult &flow : results[i])
+        {
+            table << configs[i].wifiManager << "," << configs[i].enableCtsRts << "," << configs[i].run
+                  << "," << flow.flowId << "," << flow.txPackets << "," << flow.txBytes << ","
+                  << flow.rxPackets << "," << flow.rxBytes << "," << flow.window << ","
+                  << Mbps(flow.rxBytes, flow.window) << "\n";
+        }
+    }
+
+    std::cout << std::setw(10) << "manager" << std::setw(9) << "RTS/CTS" << std::setw(6) << "runs"
+              << std::setw(24) << "flow 1 Mbps" << std::setw(24) << "flow 2 Mbps" << std::setw(24)
+              << "total Mbps" << std::setw(12) << "window s"
+              << "\n";
+    for (size_t first = 0; first < configs.size(); first += seeds)
+    {
+        // configs of one manager and mode are consecutive
+        std::vector<double> throughput[3];
+        std::vector<double> windows;
+        for (size_t i = first; i < first + seeds; ++i)
+        {
+            if (results[i].empty())
+            {
+                continue;
+            }
+            double total = 0;
+            for (const FlowResult &flow : results[i])
+            {
+                double mbps = Mbps(flow.rxBytes, flow.window);
+                if (flow.flowId <= 2)
+                {
+                    throughput[flow.flowId - 1].push_back(mbps);
+                }
+                total += mbps;
+            }
+            throughput[2].push_back(total);
+            windows.push_back(results[i].front().window);
+        }
+
+        std::cout << std::setw(10) << configs[first].wifiManager << std::setw(9)
+                  << (configs[first].enableCtsRts ? "on" : "off") << std::setw(6) << throughput[2].size();
+        for (const std::vector<double> &values : throughput)
+        {
+            double mean;
+            double halfWidth;
+            MeanAndCi(values, mean, halfWidth);
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(3) << mean << " +- " << halfWidth;
+            std::cout << std::setw(24) << cell.str();
+        }
+        double meanWindow;
+        double windowHalfWidth;
+        MeanAndCi(windows, meanWindow, windowHalfWidth);
+        std::cout << std::setw(12) << std::fixed << std::setprecision(2) << meanWindow
+                  << std::defaultfloat << "\n";
+    }
+    std::cout << "per-run rows in " << tableFile << "\n";
+}
+
+/**
+ * Runs config in a fresh child process and collects its flows, cost and peak RSS
+ *
+ * \param config run to simulate
+ * \param flows flows of the run
+ * \param cost simulator cost of the run
+ * \param peakMiB peak RSS of the child (MiB)
+ * \return false if the child failed
+ */
+static bool
+BenchmarkRun(const ExperimentConfig &config,
+             std::vector<FlowResult> &flows,
+             RunCost &cost,
+             double &peakMiB)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe failed: " << std::strerror(errno));
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork failed: " << std::strerror(errno));
+    if (pid == 0)
+    {
+        close(fds[0]);
+        RunCost childCost;
+        std::vector<FlowResult> childFlows = experiment(config, &childCost);
+        bool ok = WriteFlows(fds[1], childFlows) && WriteAll(fds[1], &childCost, sizeof(childCost));
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    flows = ReadFlows(fds[0]);
+    bool ok = !flows.empty() && ReadAll(fds[0], &cost, sizeof(cost));
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR)
+    {
+    }
+    // ru_maxrss is in KiB on Linux
+    peakMiB = usage.ru_maxrss / 1024.0;
+    return ok;
+}
+
+/**
+ * Runs the scenario once per manager and RTS/CTS setting and prints the simulated
+ * throughput next to the cost of simulating it.
+ *
+ * Runs go one at a time so they don't compete for cores or memory bandwidth, each in a
+ * fresh child process: its peak RSS (from wait4) then covers that run alone, on top of
+ * the few MiB the parent had mapped when it forked.
+ *
+ * With an OFDM standard every row runs twice, with the Nist error rate model and with
+ * --phyAbstraction, and a comparison line gives the relative difference of the table
+ * run's total throughput, checked against phyTolerance, and its run-time speedup. Both
+ * runs use the same seed, so they stay in step until a reception decision differs.
+ * Tables missing from --perTableFile are built during the first table runs and
+ * count towards their run time; a second --bench shows the steady-state speedup.
+ *
+ * \param scenario scenario to run, its manager and RTS/CTS setting are overridden
+ * \param managers managers to run
+ * \param phyTolerance largest accepted relative throughput difference, table vs Nist
+ * \return number of comparisons outside phyTolerance
+ */
+unsigned int
+RunBenchmark(const ExperimentConfig &scenario,
+             const std::vector<std::string> &managers,
+             double phyTolerance)
+{
+    // DSSS receptions never reach the tables, see BuildScenario
+    const bool comparePhy = scenario.standard != "80211b";
+    std::vector<bool> phyModes = comparePhy ? std::vector<bool>{false, true}
+                                            : std::vector<bool>{scenario.phyAbstraction};
+    std::cout << std::setw(10) << "manager" << std::setw(9) << "RTS/CTS" << std::setw(7)
+              << "PHY" << std::setw(12) << "total Mbps" << std::setw(10) << "build s"
+              << std::setw(10) << "run s" << std::setw(12) << "events" << std::setw(14)
+              << "events/s" << std::setw(12) << "peak MiB"
+              << "\n"
+              << std::flush;
+    unsigned int failures = 0;
+    double nistSeconds = 0;
+    double tableSeconds = 0;
+    for (const std::string &manager : managers)
+    {
+        for (bool enableCtsRts : {false, true})
+        {
+            double totals[2] = {0, 0};
+            double runSeconds[2] = {0, 0};
+            bool ok = true;
+            for (size_t m = 0; m < phyModes.size() && ok; ++m)
+            {
+                ExperimentConfig config = scenario;
+                config.wifiManager = manager;
+                config.enableCtsRts = enableCtsRts;
+                config.phyAbstraction = phyModes[m];
+
+                std::vector<FlowResult> flows;
+                RunCost cost;
+                double peakMiB;
+                ok = BenchmarkRun(config, flows, cost, peakMiB);
+                if (!ok)
+                {
+                    std::cerr << "benchmark run for " << manager << (enableCtsRts ? " RTS/CTS" : "")
+                              << (phyModes[m] ? " table" : "") << " failed\n";
+                    break;
+                }
+
+                for (const FlowResult &flow : flows)
+                {
+                    totals[m] += Mbps(flow.rxBytes, flow.window);
+                }
+                runSeconds[m] = cost.runSeconds;
+                std::cout << std::setw(10) << manager << std::setw(9) << (enableCtsRts ? "on" : "off")
+                          << std::setw(7) << (phyModes[m] ? "table" : "nist") << std::fixed
+                          << std::setprecision(3) << std::setw(12) << totals[m] << std::setw(10)
+                          << cost.buildSeconds << std::setw(10) << cost.runSeconds << std::setw(12)
+                          << cost.events << std::setprecision(0) << std::setw(14)
+                          << cost.events / cost.runSeconds << std::setprecision(1)
+                          << std::setw(12) << peakMiB << std::defaultfloat << "\n"
+                          << std::flush;
+            }
+            if (!comparePhy || !ok)
+            {
+                continue;
+            }
+
+            double difference = totals[0] > 0 ? (totals[1] - totals[0]) / totals[0] : 0;
+            bool passed = std::abs(difference) <= phyTolerance;
+            failures += !passed;
+            nistSeconds += runSeconds[0];
+            tableSeconds += runSeconds[1];
+            std::cout << "    table vs nist: throughput " << std::showpos << std::fixed
+                      << std::setprecision(2) << 100 * difference << std::noshowpos
+                      << "% (tolerance " << 100 * phyTolerance << "%), run "
+                      << runSeconds[0] / runSeconds[1] << "x faster, "
+                      << (passed ? "PASS" : "FAIL") << std::defaultfloat << "\n"
+                      << std::flush;
+        }
+    }
+    if (comparePhy && tableSeconds > 0)
+    {
+        std::cout << "phyAbstraction: " << std::fixed << std::setprecision(2)
+                  << nistSeconds / tableSeconds << "x faster over all runs, " << failures
+                  << " outside the throughput tolerance" << std::defaultfloat << "\n";
+    }
+    return failures;
+}
+
+/// MAC and PHY timing of a standard, for Predict
+struct DcfTiming
+{
+    double slot;        ///< slot time (us)
+    double sifs;        ///< SIFS (us)
+    double difs;        ///< DIFS (us)
+    uint32_t cwMin;     ///< default minimum contention window
+    uint32_t cwMax;     ///< default maximum contention window
+    bool dsss;          ///< DSSS/CCK PLCP, OFDM otherwise
+    double dataRate;    ///< Mbps of data frames, the highest rate at 50 dB loss
+    double ackRate;     ///< Mbps of ACKs, highest basic rate not above dataRate
+    double rtsCtsRate;  ///< Mbps of RTS and CTS, the lowest rate
+};
+
+/// Timing of config.standard
+static DcfTiming
+GetDcfTiming(const std::string &standard)
+{
+    if (standard == "80211b")
+    {
+        return DcfTiming{20, 10, 50, 31, 1023, true, 11, 2, 1};
+    }
+    // 802.11g with short slots only, i.e. no 802.11b stations, times like 802.11a
+    return DcfTiming{9, 16, 34, 15, 1023, false, 54, 24, 6};
+}
+
+/// Air time (us) of a frame of bytes at rate Mbps
+static double
+FrameDuration(const DcfTiming &timing, uint32_t bytes, double rate)
+{
+    if (timing.dsss)
+    {
+        // long PLCP preamble and header
+        return 192 + std::ceil(bytes * 8 / rate);
+    }
+    // preamble and SIGNAL, then 16 service bits, the frame and 6 tail bits in 4 us symbols
+    return 20 + 4 * std::ceil((16 + 8.0 * bytes + 6) / (4 * rate));
+}
+
+/// Estimated throughput of one CBR flow
+struct FlowPrediction
+{
+    uint32_t flowId;      ///< same numbering as FlowResult
+    uint32_t node;        ///< sending node
+    double tau;           ///< probability of transmitting in a slot
+    double collision;     ///< probability a transmission fails
+    double throughputMbps; ///< estimated throughput, capped at the offered load
+};
+
+/**
+ * Bianchi's saturated DCF model extended for hidden nodes, for the topology of config.
+ *
+ * Every sender is saturated and runs binary exponential backoff with contention windows
+ * cwMin..cwMax: its attempt probability per slot follows from its failure probability p
+ * as in Bianchi (2000), tau = 2 (1 - 2p) / ((1 - 2p)(W + 1) + p W (1 - (2p)^m)).
+ * A transmission of sender i fails if a sender it senses picks the same slot, or if a
+ * hidden sender j starts within the vulnerable window V around it. Hidden senders don't
+ * share i's slots, so j is taken to start a frame at rate tau_j / E[T_j] per microsecond,
+ * E[T_j] being the mean length of a slot as j sees it, and p_i = 1 - prod_sensed (1 - tau_j)
+ * * prod_hidden exp(-V tau_j / E[T_j]). V spans the data frames of both senders, or with
+ * RTS/CTS the RTS of j plus the RTS/CTS exchange of i, after which the CTS silences j
+ * (every sender hears the receiver) and also defers i for j's whole exchange. The fixed
+ * point is found by damped iteration.
+ *
+ * Throughput is tau_i (1 - p_i) IP bytes per E[T_i], capped at the flow's offered load.
+ * Frames go at the highest rate, which is where every manager ends up at 50 dB loss.
+ *
+ * \param config topology, RTS/CTS setting, standard and packet size
+ * \param cwMin minimum contention window, 0 for the standard's
+ * \param cwMax maximum contention window, 0 for the standard's
+ * \return one prediction per CBR flow
+ */
+std::vector<FlowPrediction> Predict(const ExperimentConfig &config, uint32_t cwMin, uint32_t cwMax)
+{
+    const DcfTiming timing = GetDcfTiming(config.standard);
+    cwMin = cwMin ? cwMin : timing.cwMin;
+    cwMax = cwMax ? cwMax : timing.cwMax;
+    const double w = cwMin + 1;
+    const double m = std::log2((cwMax + 1.0) / (cwMin + 1.0));
+
+    // UDP payload + UDP, IP, LLC/SNAP and MAC header + FCS
+    const uint32_t ipBytes = config.packetSize + 8 + 20;
+    const uint32_t mpduBytes = ipBytes + 8 + 28;
+    const double data = FrameDuration(timing, mpduBytes, timing.dataRate);
+    const double ack = FrameDuration(timing, 14, timing.ackRate);
+    const double rts = FrameDuration(timing, 20, timing.rtsCtsRate);
+    const double cts = FrameDuration(timing, 14, timing.rtsCtsRate);
+    const bool useRts = mpduBytes > RtsCtsThreshold(config).Get();
+
+    // busy time of a success and of a collision, and the hidden node vulnerable window
+    double success;
+    double collided;
+    double vulnerable;
+    if (useRts)
+    {
+        success = rts + timing.sifs + cts + timing.sifs + data + timing.sifs + ack + timing.difs;
+        collided = rts + timing.difs;
+        vulnerable = rts + rts + timing.sifs + cts;
+    }
+    else
+    {
+        success = data + timing.sifs + ack + timing.difs;
+        collided = data + timing.difs;
+        vulnerable = 2 * data;
+    }
+
+    const uint32_t senders = config.nodes - 1;
+    std::vector<uint32_t> node(senders);
+    for (uint32_t s = 0; s < senders; ++s)
+    {
+        node[s] = s == 0 ? 0 : s + 1;
+    }
+    std::vector<std::vector<bool>> hidden(config.nodes, std::vector<bool>(config.nodes, false));
+    for (const std::pair<uint32_t, uint32_t> &pair : config.hiddenPairs)
+    {
+        hidden[pair.first][pair.second] = true;
+        hidden[pair.second][pair.first] = true;
+    }
+
+    std::vector<double> tau(senders, 2.0 / (w + 1));
+    std::vector<double> p(senders, 0);
+    std::vector<double> slotLength(senders, timing.slot);
+    for (int iteration = 0; iteration < 10000; ++iteration)
+    {
+        // mean slot length as each sender sees it: idle, or busy with a success or a
+        // failure of itself or a sender it hears. With RTS/CTS the CTS of a hidden sender's
+        // successful exchange defers it as well.
+        for (uint32_t i = 0; i < senders; ++i)
+        {
+            double idle = 1;
+            double successes = 0;
+            double hiddenSuccesses = 0;
+            for (uint32_t j = 0; j < senders; ++j)
+            {
+                if (j == i || !hidden[node[i]][node[j]])
+                {
+                    idle *= 1 - tau[j];
+                    successes += tau[j] * (1 - p[j]);
+                }
+                else if (useRts)
+                {
+                    hiddenSuccesses += tau[j] * (1 - p[j]);
+                }
+            }
+            double busy = 1 - idle;
+            successes = std::min(successes, busy);
+            slotLength[i] = idle * timing.slot + successes * success + (busy - successes) * collided +
+                            hiddenSuccesses * success;
+        }
+
+        double change = 0;
+        for (uint32_t i = 0; i < senders; ++i)
+        {
+            double ok = 1;
+            for (uint32_t j = 0; j < senders; ++j)
+            {
+                if (j == i)
+                {
+                    continue;
+                }
+                ok *= hidden[node[i]][node[j]] ? std::exp(-vulnerable * tau[j] / slotLength[j])
+                                               : 1 - tau[j];
+            }
+            p[i] = 1 - ok;
+            // (1 - 2p) vanishes at p = 1/2, where tau has a finite limit
+            double q = std::abs(1 - 2 * p[i]) < 1e-9 ? 1e-9 : 1 - 2 * p[i];
+            double next = 2 * q / (q * (w + 1) + p[i] * w * (1 - std::pow(2 * p[i], m)));
+            next = 0.5 * tau[i] + 0.5 * next;
+            change = std::max(change, std::abs(next - tau[i]));
+            tau[i] = next;
+        }
+        if (change < 1e-12)
+        {
+            break;
+        }
+    }
+
+    std::vector<FlowPrediction> predictions;
+    for (uint32_t s = 0; s < senders; ++s)
+    {
+        FlowPrediction prediction;
+        prediction.flowId = s + 1;
+        prediction.node = node[s];
+        prediction.tau = tau[s];
+        prediction.collision = p[s];
+        // bits per microsecond are Mbps
+        double saturated = tau[s] * (1 - p[s]) * ipBytes * 8 / slotLength[s];
+        double offered = (config.dataRate + 1100 * s) * 1e-6 * ipBytes / config.packetSize;
+        prediction.throughputMbps = std::min(saturated, offered);
+        predictions.push_back(prediction);
+    }
+    return predictions;
+}
+
+/// Prints the predictions of config and how long they took
+void PrintPrediction(const ExperimentConfig &config, uint32_t cwMin, uint32_t cwMax)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<FlowPrediction> predictions = Predict(config, cwMin, cwMax);
+    double elapsed = SecondsSince(start);
+    for (const FlowPrediction &prediction : predictions)
+    {
+        std::cout << "Flow " << prediction.flowId << " (node " << prediction.node << " -> node 1)\n";
+        std::cout << "  tau:        " << prediction.tau << "\n";
+        std::cout << "  p(fail):    " << prediction.collision << "\n";
+        std::cout << "  Throughput: " << prediction.throughputMbps << " Mbps\n";
+    }
+    std::cout << "  (solved in " << elapsed * 1e6 << " us)\n";
+}
+
+/**
+ * Compares Predict with simulations over nodes x {no hidden pairs, all senders hidden}
+ * x RTS/CTS off/on, each simulated for runs 1..seeds in parallel. Prints the mean total
+ * throughput of both and the relative error of the prediction.
+ */
+void ValidatePrediction(const ExperimentConfig &scenario,
+                        const std::vector<uint32_t> &nodeCounts,
+                        uint32_t seeds,
+                        unsigned int jobs,
+                        const std::string &tableFile)
+{
+    std::vector<ExperimentConfig> points;
+    for (uint32_t nodes : nodeCounts)
+    {
+        for (bool hideAll : {false, true})
+        {
+            for (bool enableCtsRts : {false, true})
+            {
+                ExperimentConfig point = scenario;
+                point.nodes = nodes;
+                point.hiddenPairs = ParseHiddenPairs(hideAll ? "all" : "", nodes);
+                point.enableCtsRts = enableCtsRts;
+                points.push_back(point);
+            }
+        }
+    }
+    std::vector<ExperimentConfig> configs;
+    for (const ExperimentConfig &point : points)
+    {
+        for (uint64_t run = 1; run <= seeds; ++run)
+        {
+            ExperimentConfig config = point;
+            config.run = run;
+            configs.push_back(config);
+        }
+    }
+    std::cout << configs.size() << " runs on " << jobs << " worker processes\n" << std::flush;
+    std::vector<std::vector<FlowResult>> results = RunParallel(configs, jobs, true);
+
+    std::ofstream table(tableFile);
+    table << "nodes,hidden,rtsCts,predictedMbps,simulatedMbps,ciMbps,relativeError\n";
+    std::cout << std::setw(6) << "nodes" << std::setw(8) << "hidden" << std::setw(9) << "RTS/CTS"
+              << std::setw(12) << "predicted" << std::setw(24) << "simulated Mbps" << std::setw(10)
+              << "error"
+              << "\n";
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        const ExperimentConfig &point = points[k];
+        double predicted = 0;
+        for (const FlowPrediction &prediction : Predict(point, 0, 0))
+        {
+            predicted += prediction.throughputMbps;
+        }
+        std::vector<double> totals;
+        for (size_t i = k * seeds; i < (k + 1) * seeds; ++i)
+        {
+            if (results[i].empty())
+            {
+                continue;
+            }
+            double total = 0;
+            for (const FlowResult &flow : results[i])
+            {
+                total += Mbps(flow.rxBytes, flow.window);
+            }
+            totals.push_back(total);
+        }
+        double mean;
+        double halfWidth;
+        MeanAndCi(totals, mean, halfWidth);
+        double error = mean > 0 ? (predicted - mean) / mean : 0;
+        bool hideAll = !point.hiddenPairs.empty();
+
+        std::ostringstream simulated;
+        simulated << std::fixed << std::setprecision(3) << mean << " +- " << halfWidth;
+        std::cout << std::setw(6) << point.nodes << std::setw(8) << (hideAll ? "all" : "none")
+                  << std::setw(9) << (point.enableCtsRts ? "on" : "off") << std::fixed
+                  << std::setprecision(3) << std::setw(12) << predicted << std::setw(24)
+                  << simulated.str() << std::setprecision(1) << std::setw(9) << error * 100 << "%"
+                  << std::defaultfloat << "\n";
+        table << point.nodes << "," << (hideAll ? "all" : "none") << "," << point.enableCtsRts << ","
+              << predicted << "," << mean << "," << halfWidth << "," << error << "\n";
+    }
+    std::cout << "per-point rows in " << tableFile << "\n";
+}
+
+/// Values of "start:stop:step" (stop included) or a single value
+static std::vector<double>
+ParseGrid(const std::string &spec)
+{
+    std::vector<double> values;
+    std::istringstream is(spec);
+    double start;
+    double stop;
+    double step;
+    char colon;
+    if (!(is >> start))
+    {
+        NS_ABORT_MSG("bad grid " << spec);
+    }
+    if (!(is >> colon))
+    {
+        return {start};
+    }
+    NS_ABORT_MSG_UNLESS(colon == ':' && (is >> stop >> colon >> step) && colon == ':' && step > 0,
+                        "bad grid " << spec);
+    for (double value = start; value <= stop + step * 1e-9; value += step)
+    {
+        values.push_back(value);
+    }
+    return values;
+}
+
+/// Jain's fairness index of the flow throughputs, 1 when all are equal
+static double
+JainIndex(const std::vector<FlowResult> &flows)
+{
+    double sum = 0;
+    double sumSq = 0;
+    for (const FlowResult &flow : flows)
+    {
+        double mbps = Mbps(flow.rxBytes, flow.window);
+        sum += mbps;
+        sumSq += mbps * mbps;
+    }
+    return sumSq > 0 ? sum * sum / (flows.size() * sumSq) : 1;
+}
+
+/**
+ * Sweeps RtsCtsThreshold x packet size x offered load and writes the throughput and
+ * fairness surface.
+ *
+ * The full grid is simulated first, seeds runs per point, every run in its own worker
+ * process. Then, up to refineLevels times, each line of points along one axis (the
+ * other two coordinates fixed) is bisected between neighbours whose total throughput
+ * differs by more than refineTolerance (relative) or whose Jain index differs by more
+ * than refineTolerance, and only those midpoints are simulated. Flat regions keep their
+ * coarse spacing, the break-even region where RTS/CTS starts or stops paying off gets
+ * dense.
+ *
+ * The surface file has one row per point, sorted by load, packet size and threshold, with
+ * a blank line between (load, packet size) scan lines for gnuplot's splot.
+ */
+void RunThresholdSweep(const ExperimentConfig &scenario,
+                       const std::vector<double> &thresholds,
+                       const std::vector<double> &packetSizes,
+                       const std::vector<double> &loads,
+                       uint32_t seeds,
+                       unsigned int jobs,
+                       uint32_t refineLevels,
+                       double refineTolerance,
+                       const std::string &surfaceFile)
+{
+    // threshold (bytes), packet size (bytes), offered load per flow (Mbps)
+    typedef std::tuple<uint32_t, uint32_t, double> Point;
+    struct SurfaceValue
+    {
+        double throughput; ///< mean total throughput (Mbps)
+        double ci;         ///< its 95% confidence half-width
+        double fairness;   ///< mean Jain index
+        uint32_t runs;     ///< runs that succeeded
+        uint32_t level;    ///< refinement level the point was added at
+    };
+    std::map<Point, SurfaceValue> surface;
+
+    std::vector<Point> pending;
+    for (double threshold : thresholds)
+    {
+        for (double packetSize : packetSizes)
+        {
+            for (double load : loads)
+            {
+                // a threshold of 0 means "follow enableCtsRts" in ExperimentConfig, 1 is
+                // the same for every frame
+                pending.emplace_back(std::max<uint32_t>(1, threshold), packetSize, load);
+            }
+        }
+    }
+
+    for (uint32_t level = 0; !pending.empty(); ++level)
+    {
+        std::vector<ExperimentConfig> configs;
+        for (const Point &point : pending)
+        {
+            for (uint64_t run = 1; run <= seeds; ++run)
+            {
+                ExperimentConfig config = scenario;
+                config.rtsCtsThreshold = std::get<0>(point);
+                config.enableCtsRts = config.rtsCtsThreshold <= 100;
+                config.packetSize = std::get<1>(point);
+                config.dataRate = static_cast<uint64_t>(std::llround(std::get<2>(point) * 1e6));
+                config.run = run;
+                configs.push_back(config);
+            }
+        }
+        std::cout << "level " << level << ": " << pending.size() << " points, " << configs.size()
+                  << " runs on " << jobs << " worker processes\n"
+                  << std::flush;
+        std::vector<std::vector<FlowResult>> results = RunParallel(configs, jobs, true);
+
+        for (size_t k = 0; k < pending.size(); ++k)
+        {
+            std::vector<double> totals;
+            double fairness = 0;
+            for (size_t i = k * seeds; i < (k + 1) * seeds; ++i)
+            {
+                if (results[i].empty())
+                {
+                    continue;
+                }
+                double total = 0;
+                for (const FlowResult &flow : results[i])
+                {
+                    total += Mbps(flow.rxBytes, flow.window);
+                }
+                totals.push_back(total);
+                fairness += JainIndex(results[i]);
+            }
+            SurfaceValue value;
+            MeanAndCi(totals, value.throughput, value.ci);
+            value.fairness = totals.empty() ? 0 : fairness / totals.size();
+            value.runs = totals.size();
+            value.level = level;
+            surface[pending[k]] = value;
+        }
+        pending.clear();
+        if (level == refineLevels)
+        {
+            break;
+        }
+
+        // bisect along each axis where neighbours differ
+        std::set<Point> midpoints;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // points of each line along the axis, in order of the axis coordinate
+            std::map<Point, std::vector<Point>> lines;
+            for (const auto &entry : surface)
+            {
+                Point line = entry.first;
+                switch (axis)
+                {
+                case 0:
+                    std::get<0>(line) = 0;
+                    break;
+                case 1:
+                    std::get<1>(line) = 0;
+                    break;
+                default:
+                    std::get<2>(line) = 0;
+                }
+                lines[line].push_back(entry.first);
+            }
+            for (const auto &line : lines)
+            {
+                const std::vector<Point> &points = line.second;
+                for (size_t i = 0; i + 1 < points.size(); ++i)
+                {
+                    const SurfaceValue &a = surface[points[i]];
+                    const SurfaceValue &b = surface[points[i + 1]];
+                    double scale = std::max({a.throughput, b.throughput, 1e-9});
+                    if (std::abs(a.throughput - b.throughput) / scale <= refineTolerance &&
+                        std::abs(a.fairness - b.fairness) <= refineTolerance)
+                    {
+                        continue;
+                    }
+                    Point mid = points[i];
+                    bool distinct;
+                    switch (axis)
+                    {
+                    case 0:
+                        std::get<0>(mid) = (std::get<0>(points[i]) + std::get<0>(points[i + 1])) / 2;
+                        distinct = std::get<0>(mid) != std::get<0>(points[i]);
+                        break;
+                    case 1:
+                        std::get<1>(mid) = (std::get<1>(points[i]) + std::get<1>(points[i + 1])) / 2;
+                        distinct = std::get<1>(mid) != std::get<1>(points[i]);
+                        break;
+                    default:
+                        // kbps resolution
+                        std::get<2>(mid) =
+                            std::round((std::get<2>(points[i]) + std::get<2>(points[i + 1])) * 500) /
+                            1000;
+                        distinct = std::get<2>(mid) != std::get<2>(points[i]) &&
+                                   std::get<2>(mid) != std::get<2>(points[i + 1]);
+                    }
+                    if (distinct && surface.find(mid) == surface.end())
+                    {
+                        midpoints.insert(mid);
+                    }
+                }
+            }
+        }
+        pending.assign(midpoints.begin(), midpoints.end());
+    }
+
+    // rows by load, packet size and threshold, one gnuplot scan line per (load, size)
+    std::vector<Point> points;
+    for (const auto &entry : surface)
+    {
+        points.push_back(entry.first);
+    }
+    std::sort(points.begin(), points.end(), [](const Point &a, const Point &b) {
+        return std::make_tuple(std::get<2>(a), std::get<1>(a), std::get<0>(a)) <
+               std::make_tuple(std::get<2>(b), std::get<1>(b), std::get<0>(b));
+    });
+    std::ofstream out(surfaceFile);
+    out << "# rtsCtsThreshold packetSize loadMbps throughputMbps ciMbps fairness runs level\n";
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const Point &point = points[i];
+        if (i > 0 && (std::get<2>(point) != std::get<2>(points[i - 1]) ||
+                      std::get<1>(point) != std::get<1>(points[i - 1])))
+        {
+            out << "\n";
+        }
+        const SurfaceValue &value = surface[point];
+        out << std::get<0>(point) << " " << std::get<1>(point) << " " << std::get<2>(point) << " "
+            << value.throughput << " " << value.ci << " " << value.fairness << " " << value.runs
+            << " " << value.level << "\n";
+    }
+    std::cout << surface.size() << " points in " << surfaceFile << "\n";
 }
 
 int main(int argc, char **argv)
 {
     std::string wifiManager("Arf");
+    bool matrix = false;
+    bool bench = false;
+    bool predict = false;
+    bool sweep = false;
+    std::string thresholds("0:2400:400");
+    std::string packetSizes("200:1400:400");
+    std::string loads("1:3:1");
+    uint32_t refineLevels = 3;
+    double refineTolerance = 0.05;
+    std::string surface("rts-threshold-surface.dat");
+    bool validatePredict = false;
+    std::string validateNodes("3,4,6");
+    uint32_t packetSize = 1400;
+    uint32_t cwMin = 0;
+    uint32_t cwMax = 0;
+    std::string managers("all");
+    uint32_t seeds = 30;
+    unsigned int jobs = 0;
+    std::string table("hidden-terminal-matrix.csv");
+    uint32_t nodes = 3;
+    std::string hidden;
+    bool warmupFork = true;
+    double maxTime = SIMULATION_END.GetSeconds();
+    double ciWidth = 0;
+    double batchLength = 0.5;
+    std::string standard("80211b");
+    bool phyAbstraction = false;
+    std::string perTableFile("wifi-per-tables.txt");
+    double phyTolerance = 0.05;
     CommandLine cmd(__FILE__);
     cmd.AddValue(
         "wifiManager",
         "Set wifi rate manager (Aarf, Aarfcd, Amrr, Arf, Cara, Ideal, Minstrel, Onoe, Rraa)",
         wifiManager);
+    cmd.AddValue("matrix", "Run managers x RTS/CTS off/on x seeds in parallel worker processes", matrix);
+    cmd.AddValue("bench",
+                 "Run every manager in --managers once per RTS/CTS setting and report wall-clock "
+                 "time, events, events/s and peak RSS next to throughput",
+                 bench);
+    cmd.AddValue("predict",
+                 "Print the Bianchi/hidden-node estimate of the flow throughputs instead of "
+                 "simulating",
+                 predict);
+    cmd.AddValue("validatePredict",
+                 "Compare --predict with simulations of --wifiManager over --validateNodes x "
+                 "hidden none/all x RTS/CTS off/on",
+                 validatePredict);
+    cmd.AddValue("validateNodes", "Comma-separated node counts for --validatePredict", validateNodes);
+    cmd.AddValue("sweep",
+                 "Sweep --thresholds x --packetSizes x --loads with --seeds runs per point and "
+                 "write the throughput/fairness surface",
+                 sweep);
+    cmd.AddValue("thresholds", "RtsCtsThreshold grid (bytes) of --sweep, start:stop:step", thresholds);
+    cmd.AddValue("packetSizes", "CBR payload grid (bytes) of --sweep, start:stop:step", packetSizes);
+    cmd.AddValue("loads", "Offered load grid (Mbps per flow) of --sweep, start:stop:step", loads);
+    cmd.AddValue("refineLevels", "Times --sweep bisects between points that differ", refineLevels);
+    cmd.AddValue("refineTolerance",
+                 "Relative throughput (or Jain index) difference between neighbours that --sweep "
+                 "bisects",
+                 refineTolerance);
+    cmd.AddValue("surface", "Surface file of --sweep", surface);
+    cmd.AddValue("packetSize", "CBR payload (bytes)", packetSize);
+    cmd.AddValue("cwMin", "Minimum contention window of --predict, 0 for the standard's", cwMin);
+    cmd.AddValue("cwMax", "Maximum contention window of --predict, 0 for the standard's", cwMax);
+    cmd.AddValue("managers", "Comma-separated managers for --matrix and --bench, or all", managers);
+    cmd.AddValue("seeds", "RngRun values 1..seeds per manager and mode for --matrix", seeds);
+    cmd.AddValue("jobs", "Concurrent worker processes for --matrix (0 for the core count)", jobs);
+    cmd.AddValue("table", "CSV file for the per-run rows of --matrix", table);
+    cmd.AddValue("warmupFork",
+                 "With --matrix, run the warm-up once per manager and seed and fork the RTS/CTS "
+                 "variants from it",
+                 warmupFork);
+    cmd.AddValue("nodes", "Number of nodes, node 1 receives from all others", nodes);
+    cmd.AddValue("hidden", "Hidden node pairs, e.g. 0-2,3-4, or all for every pair of senders", hidden);
+    cmd.AddValue("maxTime", "Simulation end (s) at the latest", maxTime);
+    cmd.AddValue("ciWidth",
+                 "Stop once every flow's 95% CI half-width is below this fraction of the mean "
+                 "total throughput (0 to always run to maxTime)",
+                 ciWidth);
+    cmd.AddValue("batchLength", "Batch length (s) of the convergence monitor", batchLength);
+    cmd.AddValue("standard", "WiFi standard: 80211b, 80211a or 80211g", standard);
+    cmd.AddValue("phyAbstraction",
+                 "Decide receptions from SINR->PER tables (TableErrorRateModel) instead of the "
+                 "Nist model, OFDM standards only",
+                 phyAbstraction);
+    cmd.AddValue("perTableFile", "Cache file of the --phyAbstraction tables, empty for none", perTableFile);
+    cmd.AddValue("phyTolerance",
+                 "Relative total throughput difference between --phyAbstraction and Nist that "
+                 "--bench accepts",
+                 phyTolerance);
     cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(maxTime <= WARMUP_END.GetSeconds(), "maxTime must be past the warm-up");
+
+    ExperimentConfig scenario;
+    scenario.enableCtsRts = false;
+    scenario.wifiManager = wifiManager;
+    scenario.run = RngSeedManager::GetRun();
+    scenario.nodes = nodes;
+    scenario.hiddenPairs = ParseHiddenPairs(hidden, nodes);
+    scenario.maxTime = Seconds(maxTime);
+    scenario.ciWidth = ciWidth;
+    scenario.batchLength = Seconds(batchLength);
+    scenario.standard = standard;
+    scenario.phyAbstraction = phyAbstraction;
+    scenario.perTableFile = perTableFile;
+    scenario.packetSize = packetSize;
+
+    if (predict)
+    {
+        std::cout << "Hidden station estimate with RTS/CTS disabled:\n";
+        PrintPrediction(scenario, cwMin, cwMax);
+        std::cout << "------------------------------------------------\n";
+        std::cout << "Hidden station estimate with RTS/CTS enabled:\n";
+        scenario.enableCtsRts = true;
+        PrintPrediction(scenario, cwMin, cwMax);
+        return 0;
+    }
+    if (sweep)
+    {
+        if (jobs == 0)
+        {
+            jobs = std::max(1U, std::thread::hardware_concurrency());
+        }
+        RunThresholdSweep(scenario,
+                          ParseGrid(thresholds),
+                          ParseGrid(packetSizes),
+                          ParseGrid(loads),
+                          seeds,
+                          jobs,
+                          refineLevels,
+                          refineTolerance,
+                          surface);
+        return 0;
+    }
+    if (validatePredict)
+    {
+        std::vector<uint32_t> nodeCounts;
+        std::istringstream is(validateNodes);
+        std::string count;
+        while (std::getline(is, count, ','))
+        {
+            nodeCounts.push_back(std::stoul(count));
+        }
+        if (jobs == 0)
+        {
+            jobs = std::max(1U, std::thread::hardware_concurrency());
+        }
+        ValidatePrediction(scenario, nodeCounts, seeds, jobs, table);
+        return 0;
+    }
+
+    if (matrix || bench)
+    {
+        std::vector<std::string> list;
+        if (managers == "all")
+        {
+            list = {"Aarf", "Aarfcd", "Amrr", "Arf", "Cara", "Ideal", "Minstrel", "Onoe", "Rraa"};
+        }
+        else
+        {
+            std::istringstream is(managers);
+            std::string manager;
+            while (std::getline(is, manager, ','))
+            {
+                list.push_back(manager);
+            }
+        }
+        NS_ABORT_MSG_IF(list.empty() || seeds == 0, "nothing to run");
+        if (bench)
+        {
+            return RunBenchmark(scenario, list, phyTolerance) == 0 ? 0 : 1;
+        }
+        if (jobs == 0)
+        {
+            jobs = std::max(1U, std::thread::hardware_concurrency());
+        }
+        RunMatrix(scenario, list, seeds, jobs, warmupFork, table);
+        return 0;
+    }
 
     std::cout << "Hidden station experiment with RTS/CTS disabled:\n"
               << std::flush;
-    experiment(false, wifiManager);
+    PrintFlows(experiment(scenario));
     std::cout << "------------------------------------------------\n";
     std::cout << "Hidden station experiment with RTS/CTS enabled:\n";
-    experiment(true, wifiManager);
+    scenario.enableCtsRts = true;
+    PrintFlows(experiment(scenario));
 
     return 0;
 }
@@ -21,7 +21,12 @@
 #include "ns3/network-module.h"
 #include "ns3/point-to-point-module.h"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace ns3;
 
@@ -62,19 +67,148 @@ NS_LOG_COMPONENT_DEFINE("SixthScriptExample");
 // ===========================================================================
 //
 
+/// One congestion window change
+struct CwndRecord
+{
+    double time;      //!< Simulator::Now() in seconds
+    uint32_t oldCwnd; //!< Old congestion window.
+    uint32_t newCwnd; //!< New congestion window.
+};
+
+/**
+ * Writes CwndRecords to a stream from a background thread.
+ *
+ * The simulation thread appends records to a single-producer single-consumer ring
+ * buffer, which costs two atomic operations and no I/O. The writer thread drains it,
+ * formats the lines exactly as "time\toldCwnd\tnewCwnd\n" would be on the stream, and
+ * hands them to the stream in blocks of at least BLOCK_SIZE bytes. The stream is only
+ * flushed by Close(), which is scheduled for Simulator::Destroy.
+ *
+ * When the ring is full the simulation thread waits for the writer, records are never
+ * dropped.
+ */
+class CwndTraceWriter : public SimpleRefCount<CwndTraceWriter>
+{
+  public:
+    /**
+     * Starts the writer thread
+     *
+     * \param stream The output stream file, only the writer thread touches it from now on.
+     * \param capacity Ring buffer size in records, rounded up to a power of two.
+     */
+    CwndTraceWriter(Ptr<OutputStreamWrapper> stream, size_t capacity = 1 << 16)
+        : m_stream(stream)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        m_ring.resize(size);
+        m_mask = size - 1;
+        m_thread = std::thread(&CwndTraceWriter::Drain, this);
+    }
+
+    ~CwndTraceWriter()
+    {
+        Close();
+    }
+
+    /**
+     * Appends a record, called from the simulation thread only
+     *
+     * \param record The congestion window change.
+     */
+    void Append(const CwndRecord& record)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        while (head - m_tail.load(std::memory_order_acquire) == m_ring.size())
+        {
+            std::this_thread::yield();
+        }
+        m_ring[head & m_mask] = record;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    /// Writes out what is left, flushes the stream and stops the writer thread
+    void Close()
+    {
+        if (m_thread.joinable())
+        {
+            m_closing.store(true, std::memory_order_release);
+            m_thread.join();
+        }
+    }
+
+    /// Bytes of formatted lines collected before they are written to the stream
+    static const size_t BLOCK_SIZE = 1 << 16;
+
+  private:
+    /// Writer thread: formats records until Close() and the ring is empty
+    void Drain()
+    {
+        // same default format flags and precision as the file stream
+        std::ostringstream lines;
+        std::ostream& out = *m_stream->GetStream();
+        while (true)
+        {
+            bool closing = m_closing.load(std::memory_order_acquire);
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t head = m_head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail)
+            {
+                const CwndRecord& record = m_ring[tail & m_mask];
+                lines << record.time << "\t" << record.oldCwnd << "\t" << record.newCwnd << "\n";
+            }
+            m_tail.store(tail, std::memory_order_release);
+
+            if (lines.tellp() >= static_cast<std::streamoff>(BLOCK_SIZE) || closing)
+            {
+                const std::string block = lines.str();
+                out.write(block.data(), block.size());
+                lines.str("");
+            }
+            if (closing)
+            {
+                // closing was read before the last drain, so every record is out
+                out.flush();
+                return;
+            }
+            if (tail == head)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+    Ptr<OutputStreamWrapper> m_stream; //!< The output stream file.
+    std::vector<CwndRecord> m_ring;    //!< Ring buffer.
+    size_t m_mask;                     //!< Ring size - 1.
+    alignas(64) std::atomic<size_t> m_head{0}; //!< Records appended, written by the producer.
+    alignas(64) std::atomic<size_t> m_tail{0}; //!< Records drained, written by the writer.
+    std::atomic<bool> m_closing{false};        //!< Set by Close().
+    std::thread m_thread;                      //!< Writer thread.
+};
+
+/// Also print every change to the console. Off by default: that print is synchronous
+/// and would put the formatting and console write back on every callback.
+static bool g_logCwnd = false;
+
 /**
  * Congestion window change callback
  *
- * \param stream The output stream file.
+ * \param writer The trace writer of the output stream file.
  * \param oldCwnd Old congestion window.
  * \param newCwnd New congestion window.
  */
 static void
-CwndChange(Ptr<OutputStreamWrapper> stream, uint32_t oldCwnd, uint32_t newCwnd)
+CwndChange(Ptr<CwndTraceWriter> writer, uint32_t oldCwnd, uint32_t newCwnd)
 {
-    NS_LOG_UNCOND(Simulator::Now().GetSeconds() << "\t" << newCwnd);
-    *stream->GetStream() << Simulator::Now().GetSeconds() << "\t" << oldCwnd << "\t" << newCwnd
-                         << std::endl;
+    if (g_logCwnd)
+    {
+        NS_LOG_UNCOND(Simulator::Now().GetSeconds() << "\t" << newCwnd);
+    }
+    writer->Append(CwndRecord{Simulator::Now().GetSeconds(), oldCwnd, newCwnd});
 }
 
 /**
@@ -94,6 +228,10 @@ int
 main(int argc, char* argv[])
 {
     CommandLine cmd(__FILE__);
+    cmd.AddValue("logCwnd",
+                 "Also print every congestion window change to the console (slow), as the "
+                 "original example did; sixth.cwnd always gets them",
+                 g_logCwnd);
     cmd.Parse(argc, argv);
 
     NodeContainer nodes;
@@ -135,8 +273,10 @@ main(int argc, char* argv[])
 
     AsciiTraceHelper asciiTraceHelper;
     Ptr<OutputStreamWrapper> stream = asciiTraceHelper.CreateFileStream("sixth.cwnd");
+    Ptr<CwndTraceWriter> writer = Create<CwndTraceWriter>(stream);
+    Simulator::ScheduleDestroy(&CwndTraceWriter::Close, writer);
     ns3TcpSocket->TraceConnectWithoutContext("CongestionWindow",
-                                             MakeBoundCallback(&CwndChange, stream));
+                                             MakeBoundCallback(&CwndChange, writer));
 
     PcapHelper pcapHelper;
     Ptr<PcapFileWrapper> file =